@@ -0,0 +1,70 @@
+/*
+*
+* @file        riscv_harts.cpp
+* @version     1.0
+*
+*
+* @date        Oct 2026
+* @brief       Multi-hart driver for the ArchC RISC-V model
+*
+* Build it in place of the main.cpp acsim generates. RISCV_HARTS=<n>
+* creates n processor instances over one memory and runs the
+* instruction loop of each on a host thread of its own.
+*
+*/
+
+#include "riscv.H"
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+// Set before the harts start, so the begin behavior knows each hart has
+// a host thread of its own, and the AMOs find the host bytes of the
+// shared memory (riscv_isa.cpp)
+extern bool riscv_threaded;
+extern unsigned char *riscv_shared_mem;
+
+int sc_main(int ac, char *av[]) {
+  const char *n = getenv("RISCV_HARTS");
+  int harts = n ? atoi(n) : 1;
+  if (harts < 1)
+    harts = 1;
+
+  // Every instance's DM port is bound to this memory instead of the
+  // one it would own
+  ac_mem memory("DM", riscv_parms::AC_RAMSIZE);
+  riscv_shared_mem = (unsigned char *)memory.get_data();
+  std::vector<riscv *> procs;
+  for (int i = 0; i < harts; i++) {
+    char name[32];
+    snprintf(name, sizeof(name), "riscv%d", i);
+    procs.push_back(new riscv(name));
+    procs[i]->DM(memory);
+  }
+
+  // init loads the program and runs the begin behavior, which hands out
+  // the hart ids in this order. The harts load the same image, and each
+  // writes its argv to its own slot.
+  riscv_threaded = true;
+  for (int i = 0; i < harts; i++) {
+    procs[i]->init(ac, av);
+    // The loop must never wait on the SystemC kernel, which is not
+    // running: one batch lasts the whole program
+    procs[i]->set_instr_batch_size(~0U);
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < harts; i++)
+    threads.push_back(std::thread(&riscv::behavior, procs[i]));
+  for (int i = 0; i < harts; i++)
+    threads[i].join();
+
+  int status = procs[0]->ac_exit_status;
+  for (int i = 0; i < harts; i++) {
+    fprintf(stderr, "\nhart %d:\n", i);
+    procs[i]->PrintStat();
+    delete procs[i];
+  }
+  return status;
+}
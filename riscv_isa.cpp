@@ -18,66 +18,1467 @@
 #include "riscv_isa_init.cpp"
 #include "riscv_bhv_macros.H"
 #include <fenv.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 // Uncomment for debug Information
 #define DEBUG_MODEL
 #include "ac_debug_model.H"
 
+// Dump the vl body of vector register group vd, one word per line
+#define dbg_vreg( vd ) do { \
+  int bytes = vl * vcfg.sew; \
+  for ( int c = 0; c < bytes / 4; c++ ) \
+    dbg_printf("v%d[%d] = %d\n", ( vd ) + c / 4, c % 4, RBV[ 4 * ( vd ) + c ]); \
+  dbg_printf("bytes = %d\n\n", bytes); \
+} while ( 0 )
+
 #define Ra 1
 #define Sp 14
 
 // For using all the RISC-V parameters
 using namespace riscv_parms;
 
+// Each processor instance (hart) takes the next id in its begin behavior
 static int processors_started = 0;
+
+// Set by riscv_harts.cpp, which runs every hart on a host thread of its
+// own instead of the SystemC thread
+bool riscv_threaded = false;
+
+// Cache model hook. A cache model attached to the platform points this
+// at its handler before the simulation starts; every cbo.* instruction
+// then calls it with the hart, the operation (riscv_isa::CBO_OP_*) and
+// the block address. The handler returns the cycles the operation
+// costs, which are charged to the cycle counter; it bumps
+// HPM_CACHE_MISS itself through the hart's hpm_event if it wants.
+unsigned (*riscv_cbo_hook)(riscv_isa &hart, int op, ac_word block) = NULL;
+
+void riscv_isa::cbo_notify(int op, ac_word block) {
+  hpm_event[HPM_CBO]++;
+  if (riscv_cbo_hook)
+    extra_cycles += riscv_cbo_hook(*this, op, block);
+}
+
+// Host bytes behind the memory riscv_harts.cpp shares between the
+// harts, in guest byte order; NULL when every hart runs on the SystemC
+// thread. The AMOs, LR and SC work on this memory with host atomics, so
+// they stay atomic against the other harts' loads and stores without a
+// simulator lock. This assumes a little-endian host, like the guest.
+unsigned char *riscv_shared_mem = NULL;
+
+#define amo_word(addr) ((uint32_t *)(riscv_shared_mem + (addr)))
+
+// Swap, the ALU operations and the min/max compare of AMO*.W; returns
+// the old value
+ac_word riscv_isa::amo_rmw(int op, ac_word addr, ac_word src) {
+  if (!riscv_shared_mem) {
+    ac_word old = DM.read(addr);
+    DM.write(addr, amo_apply(op, old, src));
+    return old;
+  }
+  uint32_t *word = amo_word(addr);
+  switch (op) {
+  case AMO_SWAP: return __atomic_exchange_n(word, src, __ATOMIC_SEQ_CST);
+  case AMO_ADD: return __atomic_fetch_add(word, src, __ATOMIC_SEQ_CST);
+  case AMO_XOR: return __atomic_fetch_xor(word, src, __ATOMIC_SEQ_CST);
+  case AMO_AND: return __atomic_fetch_and(word, src, __ATOMIC_SEQ_CST);
+  case AMO_OR: return __atomic_fetch_or(word, src, __ATOMIC_SEQ_CST);
+  }
+  uint32_t old = __atomic_load_n(word, __ATOMIC_SEQ_CST);
+  while (!__atomic_compare_exchange_n(word, &old, amo_apply(op, old, src), false,
+                                      __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    ;
+  return old;
+}
+
+ac_word riscv_isa::amo_apply(int op, ac_word old, ac_word src) {
+  switch (op) {
+  case AMO_SWAP: return src;
+  case AMO_ADD: return old + src;
+  case AMO_XOR: return old ^ src;
+  case AMO_AND: return old & src;
+  case AMO_OR: return old | src;
+  case AMO_MIN: return (ac_Sword)old < (ac_Sword)src ? old : src;
+  case AMO_MAX: return (ac_Sword)old > (ac_Sword)src ? old : src;
+  case AMO_MINU: return old < src ? old : src;
+  default: return old > src ? old : src;
+  }
+}
+
+ac_word riscv_isa::amo_load(ac_word addr) {
+  return riscv_shared_mem ? __atomic_load_n(amo_word(addr), __ATOMIC_SEQ_CST) : DM.read(addr);
+}
+
+// Write value if the word still holds expect
+bool riscv_isa::amo_cas(ac_word addr, ac_word expect, ac_word value) {
+  if (riscv_shared_mem)
+    return __atomic_compare_exchange_n(amo_word(addr), &expect, value, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  if (DM.read(addr) != expect)
+    return false;
+  DM.write(addr, value);
+  return true;
+}
+
+// LR/SC reservations, one per hart, each on a cbo_block-sized granule.
+// A hart's slot holds its granule with bit 0 set, or 0 for none, and is
+// cleared with a compare-and-swap by whichever hart drops it: the owner
+// at SC, or any hart storing to the granule. Stores only scan the table
+// while some hart holds a reservation. A store can still scan just
+// before another hart's LR and write just after it, so LR also keeps
+// the value it loaded and SC writes with a compare-and-swap against it:
+// SC never succeeds over a value the LR did not see.
+#define MAX_HARTS 256
+static std::atomic<ac_word> reservation[MAX_HARTS];
+static ac_word reserved_value[MAX_HARTS];
+static std::atomic<int> reservations_held(0);
+
+static bool reservation_drop(int hart, ac_word held) {
+  if (!held || !reservation[hart].compare_exchange_strong(held, 0))
+    return false;
+  reservations_held--;
+  return true;
+}
+
+// Drop the reservations on the granules that [addr, addr + bytes) touches
+static void reservation_store(ac_word addr, ac_word bytes, ac_word granule) {
+  ac_word first = addr & ~(granule - 1);
+  ac_word last = (addr + bytes - 1) & ~(granule - 1);
+  for (int h = 0; h < processors_started && h < MAX_HARTS; h++) {
+    ac_word held = reservation[h].load();
+    if (held && (held & ~1) >= first && (held & ~1) <= last)
+      reservation_drop(h, held);
+  }
+}
+
+// cbo_block, where the stores of the syscall layer find it as well; begin
+// sets it
+static ac_word reservation_granule = 64;
+
+void riscv_store_check(ac_memport<ac_word, ac_Hword> &mem, ac_word addr, ac_word bytes);
+
+#define store_check(addr, bytes) do { \
+  if (reservations_held || snapshot_active) \
+    riscv_store_check(DM, (addr), (bytes)); \
+} while (0)
+
+// Deterministic mode. With RISCV_DETERMINISTIC=1 and the threaded
+// driver the harts take turns: the hart holding the token runs one
+// quantum, hands the token to the next running hart in mhartid order
+// and waits for it to come back. Only one hart runs at a time, so the
+// order of the harts' memory accesses, and the whole run, does not
+// depend on the host scheduler. A hart that ends passes the token on.
+static unsigned quantum = 0;
+static std::mutex quantum_lock;
+static std::condition_variable quantum_cv;
+static int quantum_turn = 0;
+static bool hart_done[MAX_HARTS];
+
+// Give the token to the next hart still running. Called with
+// quantum_lock held.
+static void quantum_pass(int hart) {
+  for (int i = 1; i <= processors_started; i++) {
+    int h = (hart + i) % processors_started;
+    if (h < MAX_HARTS && !hart_done[h]) {
+      quantum_turn = h;
+      break;
+    }
+  }
+  quantum_cv.notify_all();
+}
+
+static void quantum_sync(int hart) {
+  std::unique_lock<std::mutex> held(quantum_lock);
+  if (quantum_turn == hart)
+    quantum_pass(hart);
+  while (quantum_turn != hart)
+    quantum_cv.wait(held);
+}
+
+static void quantum_leave(int hart) {
+  std::lock_guard<std::mutex> held(quantum_lock);
+  if (hart < MAX_HARTS)
+    hart_done[hart] = true;
+  if (quantum_turn == hart)
+    quantum_pass(hart);
+}
+
 #define DEFAULT_STACK_SIZE (512 * 1024);
 
+// Host rounding mode for each rm encoding. RMM has no host equivalent
+// and rounds to nearest-even; 5 and 6 are reserved.
+static const int host_round_mode[8] = {
+  FE_TONEAREST, FE_TOWARDZERO, FE_DOWNWARD, FE_UPWARD,
+  FE_TONEAREST, FE_TONEAREST, FE_TONEAREST, FE_TONEAREST
+};
+
+// Mode currently set in the host FPU, so fesetround only runs on a change
+static __thread int host_round = FE_TONEAREST;
+
+static inline void set_host_round(unsigned rm) {
+  int mode = host_round_mode[rm & 0x7];
+  if (mode != host_round) {
+    fesetround(mode);
+    host_round = mode;
+  }
+}
+
+// Use the instruction rm field, or frm when it selects the dynamic mode
+#define fp_round(rm) set_host_round((rm) == 0x7 ? (unsigned)frm : (rm))
+
+// Take the exceptions the host raised since the last call as fflags bits
+static ac_word host_fflags() {
+  int ex = fetestexcept(FE_ALL_EXCEPT);
+  if (!ex)
+    return 0;
+  feclearexcept(FE_ALL_EXCEPT);
+  return ((ex & FE_INVALID) ? 0x10 : 0) | ((ex & FE_DIVBYZERO) ? 0x08 : 0) |
+         ((ex & FE_OVERFLOW) ? 0x04 : 0) | ((ex & FE_UNDERFLOW) ? 0x02 : 0) |
+         ((ex & FE_INEXACT) ? 0x01 : 0);
+}
+
+#define sync_fflags() (fflags = fflags | host_fflags())
+
+// Fused multiply-add, picked in the begin behavior: the FMA3 instruction
+// when the host has it, libm fma otherwise (which may be a soft routine)
+static float fma_soft_s(float a, float b, float c) { return fmaf(a, b, c); }
+static double fma_soft_d(double a, double b, double c) { return fma(a, b, c); }
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("fma")))
+static float fma_hw_s(float a, float b, float c) { return __builtin_fmaf(a, b, c); }
+__attribute__((target("fma")))
+static double fma_hw_d(double a, double b, double c) { return __builtin_fma(a, b, c); }
+#endif
+
+static float (*host_fma_s)(float, float, float) = fma_soft_s;
+static double (*host_fma_d)(double, double, double) = fma_soft_d;
+
+// Population count, picked in the begin behavior like the FMA above:
+// the POPCNT instruction when the host has it, the generic builtin else
+static int popcount_soft(ac_word x) { return __builtin_popcount(x); }
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("popcnt")))
+static int popcount_hw(ac_word x) { return __builtin_popcount(x); }
+#endif
+
+static int (*host_popcount)(ac_word) = popcount_soft;
+
+// Keeps exceptions from float math the simulator does for its own
+// purposes (e.g. vector integer division) out of the guest fflags
+struct fp_flags_guard {
+  fenv_t env;
+  fp_flags_guard() { feholdexcept(&env); }
+  ~fp_flags_guard() { fesetenv(&env); }
+};
+
+// Round to a host integer in the current rounding mode; raises NX
+static inline int64_t host_cvt(double x) {
+#if defined(__x86_64__)
+  return _mm_cvtsd_si64(_mm_set_sd(x));
+#else
+  return llrint(x);
+#endif
+}
+
+// Float to integer conversion with the RISC-V results: inputs outside
+// [lo, hi] saturate and NaN converts to hi, raising NV but not NX.
+// Values already inside the range cannot round out of it, so they go
+// straight to the host conversion, which raises NX itself.
+static int64_t fcvt_int(double x, double lo, double hi, ac_word &flags) {
+  if (x >= lo && x <= hi)
+    return host_cvt(x);
+
+  fp_flags_guard guard;
+  if (x != x) {
+    flags = 0x10;
+    return (int64_t)hi;
+  }
+  double c = x < lo - 1 ? lo - 1 : (x > hi + 1 ? hi + 1 : x);
+  int64_t r = host_cvt(c);
+  if (r < lo) {
+    flags = 0x10;
+    return (int64_t)lo;
+  }
+  if (r > hi) {
+    flags = 0x10;
+    return (int64_t)hi;
+  }
+  flags = (r != c) ? 0x01 : 0;
+  return r;
+}
+
+// Half precision (Zfh, Zvfh) is computed in float: halves are widened,
+// operated on and narrowed back. Float carries more than twice the half
+// precision, so add, sub, mul, div and sqrt still round correctly; the
+// fused multiply-adds go through double instead (half_fma). The
+// conversions are picked in the begin behavior: F16C when the host has
+// it, software versions honouring the host rounding mode otherwise.
+static float half_to_float_soft(uint16_t h) {
+  uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1F, man = h & 0x3FF, bits;
+  float f;
+  if (exp == 0) {
+    f = man * 5.9604644775390625e-8f;  // man * 2^-24, exact
+    return sign ? -f : f;
+  }
+  if (exp == 0x1F && man) {  // NaN, made quiet
+    if (!(man & 0x200))
+      feraiseexcept(FE_INVALID);
+    bits = sign | 0x7FC00000 | (man << 13);
+  } else if (exp == 0x1F)
+    bits = sign | 0x7F800000;
+  else
+    bits = sign | ((exp + 112) << 23) | (man << 13);
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+static uint16_t half_from_float_soft(float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  uint16_t sign = (x >> 16) & 0x8000;
+  uint32_t ax = x & 0x7FFFFFFF;
+
+  if (ax > 0x7F800000) {  // NaN, made quiet
+    if (!(ax & 0x400000))
+      feraiseexcept(FE_INVALID);
+    return sign | 0x7E00 | ((ax >> 13) & 0x3FF);
+  }
+  if (ax == 0x7F800000)
+    return sign | 0x7C00;
+
+  int e = (int)(ax >> 23) - 127;
+  if (e > 15) {
+    feraiseexcept(FE_OVERFLOW | FE_INEXACT);
+    bool inf = host_round == FE_TONEAREST ||
+               (host_round == FE_UPWARD && !sign) ||
+               (host_round == FE_DOWNWARD && sign);
+    return sign | (inf ? 0x7C00 : 0x7BFF);
+  }
+
+  // Keep 11 significant bits (fewer for subnormal halves); the exponent
+  // field is added so a rounding carry moves into it
+  uint32_t m = (ax & 0x7FFFFF) | (ax >= 0x00800000 ? 0x800000 : 0);
+  int shift = e >= -14 ? 13 : -1 - e;
+  if (shift > 25)
+    shift = 25;
+  uint32_t q = m >> shift, rem = m & ((1u << shift) - 1);
+  uint32_t halfway = 1u << (shift - 1);
+  uint32_t bits = (e >= -14 ? (uint32_t)(e + 14) << 10 : 0) + q;
+
+  switch (host_round) {
+    case FE_TOWARDZERO: break;
+    case FE_DOWNWARD: bits += (sign && rem); break;
+    case FE_UPWARD: bits += (!sign && rem); break;
+    default: bits += (rem > halfway || (rem == halfway && (q & 1))); break;
+  }
+  if (rem)
+    feraiseexcept(bits >= 0x7C00 ? FE_OVERFLOW | FE_INEXACT :
+                  bits < 0x400 ? FE_UNDERFLOW | FE_INEXACT : FE_INEXACT);
+  return sign | bits;
+}
+
+static void halves_to_floats_soft(float *dst, const uint16_t *src, int n) {
+  for (int i = 0; i < n; i++)
+    dst[i] = half_to_float_soft(src[i]);
+}
+
+static void floats_to_halves_soft(uint16_t *dst, const float *src, int n) {
+  for (int i = 0; i < n; i++)
+    dst[i] = half_from_float_soft(src[i]);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("f16c")))
+static float half_to_float_hw(uint16_t h) { return _cvtsh_ss(h); }
+__attribute__((target("f16c")))
+static uint16_t half_from_float_hw(float f) { return _cvtss_sh(f, _MM_FROUND_CUR_DIRECTION); }
+
+// vcvtph2ps/vcvtps2ph on four lanes at a time
+__attribute__((target("f16c")))
+static void halves_to_floats_hw(float *dst, const uint16_t *src, int n) {
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(dst + i, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *)(src + i))));
+  for (; i < n; i++)
+    dst[i] = _cvtsh_ss(src[i]);
+}
+
+__attribute__((target("f16c")))
+static void floats_to_halves_hw(uint16_t *dst, const float *src, int n) {
+  int i = 0;
+  for (; i + 4 <= n; i += 4)
+    _mm_storel_epi64((__m128i *)(dst + i),
+                     _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_CUR_DIRECTION));
+  for (; i < n; i++)
+    dst[i] = _cvtss_sh(src[i], _MM_FROUND_CUR_DIRECTION);
+}
+#endif
+
+static float (*host_h2f)(uint16_t) = half_to_float_soft;
+static uint16_t (*host_f2h)(float) = half_from_float_soft;
+static void (*host_h2f_block)(float *, const uint16_t *, int) = halves_to_floats_soft;
+static void (*host_f2h_block)(uint16_t *, const float *, int) = floats_to_halves_soft;
+
+// Double (or a 32-bit integer) to half with a single rounding: the float
+// step rounds to odd, keeping what it drops as a sticky low bit
+static uint16_t half_from_double(double d) {
+  float f = (float)d;
+  if ((double)f != d && f == f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    if (fabs((double)f) > fabs(d))
+      bits--;
+    bits |= 1;
+    memcpy(&f, &bits, sizeof(f));
+  }
+  return host_f2h(f);
+}
+
+// Half fused multiply-add with a single rounding. The product of two
+// halves is exact in double; the sum is rounded to odd there (TwoSum
+// under round-to-nearest gives the exact error), and half_from_double
+// then does the one rounding that counts, in the guest mode.
+static double fma_half_odd(double p, double c) {
+  double s = p + c;
+  double bb = s - p;
+  double e = (p - (s - bb)) + (c - bb);
+  if (e != 0 && std::isfinite(s)) {
+    uint64_t bits;
+    memcpy(&bits, &s, sizeof(bits));
+    if (!(bits & 1))
+      bits += ((e > 0) == (s > 0)) ? 1 : -1;
+    memcpy(&s, &bits, sizeof(s));
+  }
+  return s;
+}
+
+static void halves_fma(uint16_t *dst, const float *a, const float *b, const float *c, int n) {
+  double sum[8];
+  if (host_round != FE_TONEAREST)
+    fesetround(FE_TONEAREST);
+  for (int i = 0; i < n; i++)
+    sum[i] = fma_half_odd((double)a[i] * b[i], c[i]);
+  if (host_round != FE_TONEAREST)
+    fesetround(host_round);
+  for (int i = 0; i < n; i++)
+    dst[i] = half_from_double(sum[i]);
+}
+
+static uint16_t half_fma(float a, float b, float c) {
+  uint16_t h;
+  halves_fma(&h, &a, &b, &c, 1);
+  return h;
+}
+
+// Vector FP on SEW=16 (Zvfh) or SEW=32 lanes, through float temporaries
+// eight elements at a time. Only the vl body of vd is written.
+enum { VF_ADD, VF_SUB, VF_MUL, VF_DIV, VF_MACC };
+
+static void vf_lanes_in(float *dst, const void *reg, int el, int n, int sew) {
+  if (sew == 2)
+    host_h2f_block(dst, (const uint16_t *)reg + el, n);
+  else
+    memcpy(dst, (const float *)reg + el, n * sizeof(float));
+}
+
+static void vf_lanes_out(void *reg, const float *src, int el, int n, int sew) {
+  if (sew == 2)
+    host_f2h_block((uint16_t *)reg + el, src, n);
+  else
+    memcpy((float *)reg + el, src, n * sizeof(float));
+}
+
+// vd = vs2 op vs1, or vs2 op scalar when vs1 is null; VF_MACC adds the
+// product to vd
+static void vf_binop(int op, void *vd, const void *vs2, const void *vs1,
+                     float scalar, int vl, int sew) {
+  float a[8], b[8], c[8];
+  if (sew != 2 && sew != 4)
+    return;
+  for (int el = 0; el < vl; el += 8) {
+    int n = (vl - el < 8) ? vl - el : 8;
+    vf_lanes_in(a, vs2, el, n, sew);
+    if (vs1)
+      vf_lanes_in(b, vs1, el, n, sew);
+    else
+      for (int i = 0; i < n; i++)
+        b[i] = scalar;
+    if (op == VF_MACC)
+      vf_lanes_in(c, vd, el, n, sew);
+    if (op == VF_MACC && sew == 2) {
+      halves_fma((uint16_t *)vd + el, b, a, c, n);
+      continue;
+    }
+    for (int i = 0; i < n; i++) {
+      switch (op) {
+        case VF_ADD: c[i] = a[i] + b[i]; break;
+        case VF_SUB: c[i] = a[i] - b[i]; break;
+        case VF_MUL: c[i] = a[i] * b[i]; break;
+        case VF_DIV: c[i] = a[i] / b[i]; break;
+        case VF_MACC: c[i] = host_fma_s(b[i], a[i], c[i]); break;
+      }
+    }
+    vf_lanes_out(vd, c, el, n, sew);
+  }
+}
+
+// The f register operand of a .vf instruction at the current SEW
+#define vf_scalar(r) (vcfg.sew == 2 ? host_h2f(load_half(r)) : load_float(r))
+
+// Checkpoints. A checkpoint file holds a header, the architectural state
+// (registers, CSRs, counters), the host files the program has open, the
+// index of the guest pages holding any non-zero byte and, from a
+// page-aligned offset, the contents of those pages. Restore maps the
+// file, clears the memory the loader wrote and copies the listed pages
+// in.
+#define CKPT_MAGIC "RVCKPT1"
+#define CKPT_PAGE 4096
+
+struct ckpt_header {
+  char magic[8];
+  uint32_t npages;
+  uint32_t nfds;
+  uint64_t data_offset;
+};
+
+struct ckpt_fd {
+  int32_t fd;
+  int32_t flags;
+  int64_t offset;
+  char path[256];
+};
+
+// Host descriptors the guest opened, and the program's ELF file, kept by
+// the syscall layer
+extern std::set<int> riscv_guest_fds;
+extern std::mutex riscv_guest_fds_lock;
+extern const char *riscv_program;
+
+// The guest's descriptors on regular files, with their paths and offsets
+static void ckpt_collect_fds(std::vector<ckpt_fd> &fds) {
+  std::lock_guard<std::mutex> hold(riscv_guest_fds_lock);
+  for (std::set<int>::iterator it = riscv_guest_fds.begin(); it != riscv_guest_fds.end(); ++it) {
+    int fd = *it;
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode))
+      continue;
+    ckpt_fd rec;
+    memset(&rec, 0, sizeof(rec));
+    char link[64];
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+    ssize_t len = readlink(link, rec.path, sizeof(rec.path) - 1);
+    if (len <= 0)
+      continue;
+    rec.fd = fd;
+    rec.flags = fcntl(fd, F_GETFL);
+    rec.offset = lseek(fd, 0, SEEK_CUR);
+    fds.push_back(rec);
+  }
+}
+
+// Reopen the guest's files under their old numbers. A number already in
+// use in this process makes the restore fail rather than close it.
+static bool ckpt_reopen_fds(const ckpt_fd *fds, int n) {
+  for (int i = 0; i < n; i++) {
+    if (fcntl(fds[i].fd, F_GETFD) != -1) {
+      fprintf(stderr, "checkpoint: descriptor %d for %s is already in use\n",
+              fds[i].fd, fds[i].path);
+      return false;
+    }
+    int fd = open(fds[i].path, fds[i].flags & ~(O_CREAT | O_TRUNC | O_EXCL));
+    if (fd < 0) {
+      fprintf(stderr, "checkpoint: cannot reopen %s\n", fds[i].path);
+      return false;
+    }
+    if (fd != fds[i].fd) {
+      dup2(fd, fds[i].fd);
+      close(fd);
+    }
+    lseek(fds[i].fd, fds[i].offset, SEEK_SET);
+    std::lock_guard<std::mutex> hold(riscv_guest_fds_lock);
+    riscv_guest_fds.insert(fds[i].fd);
+  }
+  return true;
+}
+
+// The guest memory the loader wrote before a restore: the loadable
+// segments of the program and hart 0's argv slot at the top of memory.
+// False if the program cannot be read.
+static bool ckpt_loaded_ranges(std::vector<std::pair<uint32_t, uint32_t> > &ranges) {
+  FILE *f = riscv_program ? fopen(riscv_program, "rb") : NULL;
+  if (!f)
+    return false;
+  Elf32_Ehdr eh;
+  bool ok = fread(&eh, sizeof(eh), 1, f) == 1 && !memcmp(eh.e_ident, ELFMAG, SELFMAG) &&
+            eh.e_ident[EI_CLASS] == ELFCLASS32 && !fseek(f, eh.e_phoff, SEEK_SET);
+  for (int i = 0; ok && i < eh.e_phnum; i++) {
+    Elf32_Phdr ph;
+    ok = fread(&ph, sizeof(ph), 1, f) == 1;
+    if (ok && ph.p_type == PT_LOAD && ph.p_memsz)
+      ranges.push_back(std::make_pair(ph.p_vaddr, ph.p_vaddr + ph.p_memsz));
+  }
+  fclose(f);
+  ranges.push_back(std::make_pair(AC_RAM_END - 64 * 1024, AC_RAM_END));
+  return ok;
+}
+
+// Checkpoint points: one at RISCV_CHECKPOINT_AT, or the start of each
+// interval listed in RISCV_SIMPOINTS. In the second case the file name
+// gets the interval number as a suffix and the run stops after the last.
+struct ckpt_point {
+  unsigned long long at;
+  long interval;  // -1 for RISCV_CHECKPOINT_AT
+};
+static std::vector<ckpt_point> ckpt_points;
+static size_t ckpt_next = 0;
+static const char *ckpt_path = NULL;
+
+static bool ckpt_point_less(const ckpt_point &a, const ckpt_point &b) {
+  return a.at < b.at;
+}
+
+// SimPoint output: one "<interval> <cluster>" line per simulation point
+static bool ckpt_read_simpoints(const char *path, unsigned long long interval) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return false;
+  long point, cluster;
+  while (fscanf(f, "%ld %ld", &point, &cluster) == 2) {
+    ckpt_point p = { point * interval, point };
+    ckpt_points.push_back(p);
+  }
+  fclose(f);
+  std::sort(ckpt_points.begin(), ckpt_points.end(), ckpt_point_less);
+  return true;
+}
+
+// Architectural state saved with each checkpoint or snapshot
+struct ckpt_state {
+  uint32_t pc;
+  uint64_t instr;
+  uint32_t rb[32];
+  uint64_t rbf[32];
+  uint32_t rbv[128];
+  uint32_t fflags, frm, vstart, vcsr, vl, vtype;
+  uint64_t extra_cycles, compressed_count;
+  uint64_t hpm_event[riscv_isa::HPM_EVENTS + 1];
+  uint32_t hpm_select[32];
+  uint64_t hpm_base[32];
+};
+
+void riscv_isa::state_get(ckpt_state &st) {
+  sync_fflags();
+  st.pc = ac_pc;
+  st.instr = ac_instr_counter;
+  for (int i = 0; i < 32; i++) {
+    st.rb[i] = RB[i];
+    st.rbf[i] = RBF[i].data;
+  }
+  for (int i = 0; i < 128; i++)
+    st.rbv[i] = RBV[i];
+  st.fflags = fflags;
+  st.frm = frm;
+  st.vstart = vstart;
+  st.vcsr = vcsr;
+  st.vl = vl;
+  st.vtype = vcfg.raw;
+  st.extra_cycles = extra_cycles;
+  st.compressed_count = compressed_count;
+  memcpy(st.hpm_event, hpm_event, sizeof(st.hpm_event));
+  memcpy(st.hpm_select, hpm_select, sizeof(st.hpm_select));
+  memcpy(st.hpm_base, hpm_base, sizeof(st.hpm_base));
+}
+
+void riscv_isa::state_set(const ckpt_state &st) {
+  ac_pc = st.pc;
+  ac_instr_counter = st.instr;
+  for (int i = 0; i < 32; i++) {
+    RB[i] = st.rb[i];
+    RBF[i].data = st.rbf[i];
+  }
+  for (int i = 0; i < 128; i++)
+    RBV[i] = st.rbv[i];
+  fflags = st.fflags;
+  frm = st.frm;
+  vstart = st.vstart;
+  vcsr = st.vcsr;
+  vset_vtype(st.vtype);
+  vl = st.vl;
+  extra_cycles = st.extra_cycles;
+  compressed_count = st.compressed_count;
+  memcpy(hpm_event, st.hpm_event, sizeof(st.hpm_event));
+  memcpy(hpm_select, st.hpm_select, sizeof(st.hpm_select));
+  memcpy(hpm_base, st.hpm_base, sizeof(st.hpm_base));
+}
+
+bool riscv_isa::checkpoint_save(const char *path) {
+  FILE *f = fopen(path, "wb");
+  if (!f) {
+    fprintf(stderr, "checkpoint: cannot create %s\n", path);
+    return false;
+  }
+  ckpt_state st;
+  state_get(st);
+
+  std::vector<ckpt_fd> fds;
+  ckpt_collect_fds(fds);
+
+  std::vector<uint32_t> pages;
+  for (uint64_t addr = 0; addr < AC_RAMSIZE; addr += CKPT_PAGE)
+    for (int w = 0; w < CKPT_PAGE; w += 4)
+      if (DM.read(addr + w)) {
+        pages.push_back(addr);
+        break;
+      }
+
+  ckpt_header h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, CKPT_MAGIC, sizeof(h.magic));
+  h.npages = pages.size();
+  h.nfds = fds.size();
+  uint64_t meta = sizeof(h) + sizeof(st) + fds.size() * sizeof(ckpt_fd) +
+                  pages.size() * sizeof(uint32_t);
+  h.data_offset = (meta + CKPT_PAGE - 1) & ~(uint64_t)(CKPT_PAGE - 1);
+
+  fwrite(&h, sizeof(h), 1, f);
+  fwrite(&st, sizeof(st), 1, f);
+  if (!fds.empty())
+    fwrite(&fds[0], sizeof(ckpt_fd), fds.size(), f);
+  if (!pages.empty())
+    fwrite(&pages[0], sizeof(uint32_t), pages.size(), f);
+  fseek(f, h.data_offset, SEEK_SET);
+  uint32_t page[CKPT_PAGE / 4];
+  for (size_t p = 0; p < pages.size(); p++) {
+    for (int w = 0; w < CKPT_PAGE / 4; w++)
+      page[w] = DM.read(pages[p] + 4 * w);
+    fwrite(page, sizeof(page), 1, f);
+  }
+  bool ok = !ferror(f);
+  fclose(f);
+  fprintf(stderr, "checkpoint: saved %s at %llu instructions, %u pages\n",
+          path, (unsigned long long)st.instr, h.npages);
+  return ok;
+}
+
+bool riscv_isa::checkpoint_restore(const char *path) {
+  int fd = open(path, O_RDONLY);
+  struct stat sb;
+  if (fd < 0 || fstat(fd, &sb)) {
+    fprintf(stderr, "checkpoint: cannot open %s\n", path);
+    return false;
+  }
+  const char *map = (const char *)mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  // The tables must fit before the page data, and the page data in the
+  // file; every descriptor path must be terminated and every page must
+  // be an aligned guest page
+  ckpt_header h;
+  memset(&h, 0, sizeof(h));
+  bool ok = (uint64_t)sb.st_size >= sizeof(h);
+  if (ok)
+    memcpy(&h, map, sizeof(h));
+  uint64_t meta = sizeof(h) + sizeof(ckpt_state) + (uint64_t)h.nfds * sizeof(ckpt_fd) +
+                  (uint64_t)h.npages * sizeof(uint32_t);
+  ok = ok && !memcmp(h.magic, CKPT_MAGIC, sizeof(h.magic)) && meta <= h.data_offset &&
+       h.data_offset + (uint64_t)h.npages * CKPT_PAGE <= (uint64_t)sb.st_size;
+  ckpt_state st;
+  const ckpt_fd *fds = (const ckpt_fd *)(map + sizeof(h) + sizeof(st));
+  const uint32_t *pages = (const uint32_t *)(fds + (ok ? h.nfds : 0));
+  for (uint32_t i = 0; ok && i < h.nfds; i++)
+    ok = memchr(fds[i].path, 0, sizeof(fds[i].path)) != NULL;
+  for (uint32_t p = 0; ok && p < h.npages; p++)
+    ok = pages[p] % CKPT_PAGE == 0 && (uint64_t)pages[p] + CKPT_PAGE <= AC_RAMSIZE;
+  if (!ok) {
+    fprintf(stderr, "checkpoint: %s is not a checkpoint\n", path);
+    munmap((void *)map, sb.st_size);
+    return false;
+  }
+  memcpy(&st, map + sizeof(h), sizeof(st));
+
+  if (!ckpt_reopen_fds(fds, h.nfds)) {
+    munmap((void *)map, sb.st_size);
+    return false;
+  }
+  state_set(st);
+
+  // Clear what the loader wrote, then copy the saved pages in. Any other
+  // memory is still zero. If the program cannot be read, clear it all.
+  std::vector<std::pair<uint32_t, uint32_t> > ranges;
+  if (!ckpt_loaded_ranges(ranges)) {
+    ranges.clear();
+    ranges.push_back(std::make_pair(0u, (uint32_t)AC_RAMSIZE));
+  }
+  for (size_t r = 0; r < ranges.size(); r++) {
+    uint32_t end = std::min((uint64_t)ranges[r].second, (uint64_t)AC_RAMSIZE);
+    for (uint32_t addr = ranges[r].first & ~3u; addr < end; addr += 4)
+      if (DM.read(addr))
+        DM.write(addr, 0);
+  }
+  for (uint32_t p = 0; p < h.npages; p++) {
+    const uint32_t *data = (const uint32_t *)(map + h.data_offset + (uint64_t)p * CKPT_PAGE);
+    for (int w = 0; w < CKPT_PAGE / 4; w++)
+      DM.write(pages[p] + 4 * w, data[w]);
+  }
+  munmap((void *)map, sb.st_size);
+  fprintf(stderr, "checkpoint: restored %s at %llu instructions\n",
+          path, (unsigned long long)st.instr);
+  return true;
+}
+
+void riscv_isa::checkpoint_next() {
+  while (ckpt_next < ckpt_points.size() && ckpt_points[ckpt_next].at <= ac_instr_counter) {
+    const ckpt_point &p = ckpt_points[ckpt_next++];
+    if (p.interval < 0) {
+      checkpoint_save(ckpt_path);
+      continue;
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s.%ld", ckpt_path, p.interval);
+    checkpoint_save(path);
+    if (ckpt_next == ckpt_points.size())
+      stop();
+  }
+  checkpoint_at = ckpt_next < ckpt_points.size() ? ckpt_points[ckpt_next].at : NO_EVENT;
+}
+
+// Detailed instrumentation, the basic-block vectors among it, runs
+// while detail_on is set: always, or with RISCV_ROI_ONLY=1 only inside
+// the guest's regions of interest
+static bool roi_only = false;
+static bool detail_on = true;
+
+// Basic-block vectors for SimPoint. With RISCV_BBV=<file> hart 0 counts
+// the instructions it retires in each basic block and writes one
+// "T:block:count ..." line per RISCV_BBV_INTERVAL instructions. A block
+// starts wherever control does not fall through from the instruction
+// before, so it is identified by its entry PC.
+static FILE *bbv_file = NULL;
+static bool bbv_on = false;  // bbv_file && detail_on
+static unsigned long long bbv_interval = 100000000;
+static unsigned long long bbv_left = 0;
+static ac_word bbv_pc = ~0u;
+static unsigned long long bbv_compressed = 0;
+static uint32_t bbv_block = 0;
+static std::unordered_map<ac_word, uint32_t> bbv_ids;
+static std::vector<unsigned long long> bbv_counts(1);
+static std::vector<uint32_t> bbv_touched;
+
+static void bbv_flush() {
+  if (bbv_touched.empty())
+    return;
+  fputc('T', bbv_file);
+  for (size_t i = 0; i < bbv_touched.size(); i++) {
+    fprintf(bbv_file, ":%u:%llu ", bbv_touched[i], bbv_counts[bbv_touched[i]]);
+    bbv_counts[bbv_touched[i]] = 0;
+  }
+  fputc('\n', bbv_file);
+  bbv_touched.clear();
+}
+
+static inline void bbv_step(ac_word pc, unsigned long long compressed) {
+  if (pc != bbv_pc + (compressed != bbv_compressed ? 2 : 4)) {
+    bbv_block = bbv_ids.emplace(pc, bbv_ids.size() + 1).first->second;
+    if (bbv_block >= bbv_counts.size())
+      bbv_counts.resize(bbv_block + 1);
+  }
+  if (bbv_counts[bbv_block]++ == 0)
+    bbv_touched.push_back(bbv_block);
+  bbv_pc = pc;
+  bbv_compressed = compressed;
+  if (--bbv_left == 0) {
+    bbv_flush();
+    bbv_left = bbv_interval;
+  }
+}
+
+// Hot-spot profiler. With RISCV_PROFILE=<prefix> hart 0 counts the
+// instructions it retires and the vector elements they process at each
+// PC, and follows calls (JAL/JALR writing ra) and returns (JALR x0, ra)
+// in a tree of call stacks. At the end <prefix>.txt gets the counts per
+// function and per PC, named from the ELF symbol table, and
+// <prefix>.folded the instructions per call stack for flamegraph.pl.
+struct prof_pc {
+  unsigned long long instr, velem;
+};
+
+struct prof_frame {
+  uint32_t parent;
+  ac_word func;  // call target, 0 for the root
+  unsigned long long instr;
+};
+
+#define PROF_PAGES ((AC_RAMSIZE + 4095) >> 12)
+
+static const char *prof_prefix = NULL;
+static bool prof_on = false;  // prof_prefix && detail_on
+static prof_pc *prof_page[PROF_PAGES];
+static prof_pc *prof_last = NULL;
+static unsigned long long prof_velem = 0;
+static std::vector<prof_frame> prof_frames(1);
+static std::unordered_map<uint64_t, uint32_t> prof_children;
+static uint32_t prof_frame_id = 0;
+
+static uint32_t prof_child(uint32_t parent, ac_word func) {
+  uint64_t key = ((uint64_t)parent << 32) | func;
+  std::unordered_map<uint64_t, uint32_t>::iterator it = prof_children.find(key);
+  if (it != prof_children.end())
+    return it->second;
+  prof_frame n = { parent, func, 0 };
+  prof_frames.push_back(n);
+  prof_children[key] = prof_frames.size() - 1;
+  return prof_frames.size() - 1;
+}
+
+static inline void prof_step(ac_word pc, unsigned long long velem) {
+  if (prof_last)
+    prof_last->velem += velem - prof_velem;
+  prof_velem = velem;
+  prof_last = NULL;
+  if ((pc >> 12) >= PROF_PAGES)
+    return;
+  prof_pc *&page = prof_page[pc >> 12];
+  if (!page)
+    page = (prof_pc *)calloc(2048, sizeof(prof_pc));
+  prof_last = &page[(pc & 0xFFF) >> 1];
+  prof_last->instr++;
+  // Outside any call seen so far, the PC itself opens the first frame
+  if (prof_frame_id == 0)
+    prof_frame_id = prof_child(0, pc);
+  prof_frames[prof_frame_id].instr++;
+}
+
+#define prof_call(target) do { \
+  if (prof_on && id == 0) \
+    prof_frame_id = prof_child(prof_frame_id, (target)); \
+} while (0)
+
+#define prof_return() do { \
+  if (prof_on && id == 0 && prof_frame_id) \
+    prof_frame_id = prof_frames[prof_frame_id].parent; \
+} while (0)
+
+// Function symbols of the program, sorted by address
+struct prof_sym {
+  ac_word addr;
+  std::string name;
+};
+
+static bool prof_sym_less(const prof_sym &a, const prof_sym &b) {
+  return a.addr < b.addr;
+}
+
+static std::vector<prof_sym> prof_load_symbols(const char *path) {
+  std::vector<prof_sym> syms;
+  FILE *f = path ? fopen(path, "rb") : NULL;
+  if (!f)
+    return syms;
+  std::vector<char> elf;
+  char buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    elf.insert(elf.end(), buf, buf + n);
+  fclose(f);
+
+  const Elf32_Ehdr *eh = (const Elf32_Ehdr *)elf.data();
+  if (elf.size() < sizeof(Elf32_Ehdr) || memcmp(eh->e_ident, ELFMAG, SELFMAG) ||
+      eh->e_ident[EI_CLASS] != ELFCLASS32 ||
+      eh->e_shoff + (uint64_t)eh->e_shnum * sizeof(Elf32_Shdr) > elf.size())
+    return syms;
+  const Elf32_Shdr *sh = (const Elf32_Shdr *)(elf.data() + eh->e_shoff);
+  for (int i = 0; i < eh->e_shnum; i++) {
+    if (sh[i].sh_type != SHT_SYMTAB || sh[i].sh_link >= eh->e_shnum)
+      continue;
+    const Elf32_Shdr &strtab = sh[sh[i].sh_link];
+    if (sh[i].sh_offset + (uint64_t)sh[i].sh_size > elf.size() ||
+        strtab.sh_offset + (uint64_t)strtab.sh_size > elf.size())
+      continue;
+    const Elf32_Sym *sym = (const Elf32_Sym *)(elf.data() + sh[i].sh_offset);
+    for (size_t k = 0; k < sh[i].sh_size / sizeof(Elf32_Sym); k++) {
+      int type = ELF32_ST_TYPE(sym[k].st_info);
+      int sec = sym[k].st_shndx;
+      if (sec == SHN_UNDEF || sec >= SHN_LORESERVE || sec >= eh->e_shnum ||
+          sym[k].st_name >= strtab.sh_size)
+        continue;
+      if (type != STT_FUNC && !(type == STT_NOTYPE && (sh[sec].sh_flags & SHF_EXECINSTR)))
+        continue;
+      const char *name = elf.data() + strtab.sh_offset + sym[k].st_name;
+      if (!*name || *name == '.' || *name == '$')
+        continue;
+      prof_sym s = { sym[k].st_value, std::string(name, strnlen(name, strtab.sh_size - sym[k].st_name)) };
+      syms.push_back(s);
+    }
+  }
+  std::sort(syms.begin(), syms.end(), prof_sym_less);
+  return syms;
+}
+
+// Name of the function holding pc, with the offset into it if wanted
+static std::string prof_name(const std::vector<prof_sym> &syms, ac_word pc, bool offset) {
+  prof_sym key = { pc, "" };
+  std::vector<prof_sym>::const_iterator it =
+      std::upper_bound(syms.begin(), syms.end(), key, prof_sym_less);
+  char text[32];
+  if (it == syms.begin()) {
+    snprintf(text, sizeof(text), "%#x", pc);
+    return text;
+  }
+  --it;
+  if (!offset || pc == it->addr)
+    return it->name;
+  snprintf(text, sizeof(text), "+%#x", pc - it->addr);
+  return it->name + text;
+}
+
+struct prof_row {
+  std::string name;
+  ac_word pc;
+  unsigned long long instr, velem;
+};
+
+static bool prof_row_hotter(const prof_row &a, const prof_row &b) {
+  return a.instr > b.instr;
+}
+
+static void prof_report() {
+  std::vector<prof_sym> syms = prof_load_symbols(riscv_program);
+  std::vector<prof_row> pcs;
+  std::map<std::string, prof_row> funcs;
+  unsigned long long total = 0;
+  for (uint32_t p = 0; p < PROF_PAGES; p++) {
+    if (!prof_page[p])
+      continue;
+    for (int i = 0; i < 2048; i++) {
+      const prof_pc &c = prof_page[p][i];
+      if (!c.instr)
+        continue;
+      ac_word pc = (p << 12) | (i << 1);
+      prof_row row = { prof_name(syms, pc, true), pc, c.instr, c.velem };
+      pcs.push_back(row);
+      prof_row &func = funcs[prof_name(syms, pc, false)];
+      func.instr += c.instr;
+      func.velem += c.velem;
+      total += c.instr;
+    }
+  }
+  std::vector<prof_row> by_func;
+  for (std::map<std::string, prof_row>::iterator it = funcs.begin(); it != funcs.end(); ++it) {
+    it->second.name = it->first;
+    by_func.push_back(it->second);
+  }
+  std::stable_sort(by_func.begin(), by_func.end(), prof_row_hotter);
+  std::stable_sort(pcs.begin(), pcs.end(), prof_row_hotter);
+
+  std::string path = std::string(prof_prefix) + ".txt";
+  FILE *f = fopen(path.c_str(), "w");
+  if (!f) {
+    fprintf(stderr, "profile: cannot create %s\n", path.c_str());
+    return;
+  }
+  double scale = total ? 100.0 / total : 0;
+  fprintf(f, "%llu instructions\n\n", total);
+  fprintf(f, "%14s %7s %14s  %s\n", "instructions", "%", "velements", "function");
+  for (size_t i = 0; i < by_func.size(); i++)
+    fprintf(f, "%14llu %6.2f%% %14llu  %s\n", by_func[i].instr, by_func[i].instr * scale,
+            by_func[i].velem, by_func[i].name.c_str());
+  fprintf(f, "\n%10s %14s %7s %14s  %s\n", "pc", "instructions", "%", "velements", "location");
+  for (size_t i = 0; i < pcs.size() && i < 100; i++)
+    fprintf(f, "%#10x %14llu %6.2f%% %14llu  %s\n", pcs[i].pc, pcs[i].instr, pcs[i].instr * scale,
+            pcs[i].velem, pcs[i].name.c_str());
+  fclose(f);
+
+  // Collapsed stacks: one "outer;...;inner count" line per distinct stack
+  std::map<std::string, unsigned long long> stacks;
+  for (size_t n = 1; n < prof_frames.size(); n++) {
+    if (!prof_frames[n].instr)
+      continue;
+    std::string stack;
+    for (uint32_t k = n; k; k = prof_frames[k].parent)
+      stack = prof_name(syms, prof_frames[k].func, false) + (stack.empty() ? "" : ";") + stack;
+    stacks[stack] += prof_frames[n].instr;
+  }
+  path = std::string(prof_prefix) + ".folded";
+  f = fopen(path.c_str(), "w");
+  if (!f) {
+    fprintf(stderr, "profile: cannot create %s\n", path.c_str());
+    return;
+  }
+  for (std::map<std::string, unsigned long long>::iterator it = stacks.begin(); it != stacks.end(); ++it)
+    fprintf(f, "%s %llu\n", it->first.c_str(), it->second);
+  fclose(f);
+}
+
+static void detail_set(bool on) {
+  detail_on = on;
+  bbv_on = bbv_file && on;
+  bbv_pc = ~0u;
+  prof_on = prof_prefix && on;
+  prof_last = NULL;
+  prof_frame_id = 0;
+}
+
+static const char *hpm_event_name[] = {
+  "none", "loads", "stores", "branches", "fp", "vector", "velements",
+  "vload_bytes", "vstore_bytes", "taken", "cache_misses", "cbo"
+};
+
+void riscv_isa::stats_print(const stats_window &w, const char *what, unsigned long long n) {
+  fprintf(stderr, "%s %llu: %llu instructions, %llu cycles", what, n,
+          count_instret() - w.instr, count_cycle() - w.cycle);
+  for (int e = HPM_NONE + 1; e < HPM_EVENTS; e++)
+    if (hpm_event[e] != w.event[e])
+      fprintf(stderr, ", %s %llu", hpm_event_name[e], hpm_event[e] - w.event[e]);
+  fputc('\n', stderr);
+}
+
+void riscv_isa::instr_events() {
+  if (ac_instr_counter >= checkpoint_at)
+    checkpoint_next();
+  if (ac_instr_counter >= sample_end) {
+    stats_print(sample_stats, "sample from", sample_stats.instr);
+    sample_end = NO_EVENT;
+    stop();
+  }
+  instr_event = std::min(checkpoint_at, sample_end);
+}
+
+// Regions of interest do not nest: entering one closes any still open
+void riscv_isa::roi_begin(ac_word region) {
+  if (roi_open)
+    roi_end(roi_id);
+  roi_open = true;
+  roi_id = region;
+  stats_mark(roi_stats);
+  if (roi_only)
+    detail_set(true);
+}
+
+void riscv_isa::roi_end(ac_word region) {
+  if (!roi_open || region != roi_id)
+    return;
+  stats_print(roi_stats, "region", region);
+  roi_open = false;
+  if (roi_only)
+    detail_set(false);
+}
+
+// Snapshots for repeated runs. Writing 1 to the snapshot CSR saves the
+// architectural state; from then on the first store to each page, by
+// the guest or by the syscall layer for it, copies the page aside and
+// marks it in a bitmap. Writing 2 puts those pages and the saved state
+// back, so a reset costs as much as the pages the run touched. Reading
+// the CSR gives the number of resets so far.
+#define SNAPSHOT_PAGES ((AC_RAMSIZE + CKPT_PAGE - 1) / CKPT_PAGE)
+
+static bool snapshot_active = false;
+static ckpt_state snapshot_state;
+static uint64_t snapshot_dirty[(SNAPSHOT_PAGES + 63) / 64];
+static std::vector<uint32_t> snapshot_pages;  // dirty pages, in touch order
+static std::vector<uint32_t> snapshot_data;   // their contents at snapshot time
+
+// Whether page has to be saved before its first write since the snapshot
+static bool snapshot_clean(unsigned page) {
+  return page < SNAPSHOT_PAGES && !((snapshot_dirty[page / 64] >> (page % 64)) & 1);
+}
+
+static void snapshot_save(unsigned page, const unsigned *words) {
+  snapshot_dirty[page / 64] |= 1ULL << (page % 64);
+  snapshot_pages.push_back(page);
+  snapshot_data.insert(snapshot_data.end(), words, words + CKPT_PAGE / 4);
+}
+
+// Before [addr, addr + bytes) of guest memory is written, by a hart or by
+// the syscall layer for it: drops the reservations on the granules it
+// covers and saves the pages it touches first since the snapshot
+void riscv_store_check(ac_memport<ac_word, ac_Hword> &mem, ac_word addr, ac_word bytes) {
+  if (!bytes)
+    return;
+  if (reservations_held)
+    reservation_store(addr, bytes, reservation_granule);
+  if (!snapshot_active)
+    return;
+  for (uint32_t p = addr / CKPT_PAGE; p <= (addr + bytes - 1) / CKPT_PAGE; p++) {
+    if (!snapshot_clean(p))
+      continue;
+    unsigned words[CKPT_PAGE / 4];
+    for (int w = 0; w < CKPT_PAGE / 4; w++)
+      words[w] = mem.read(p * CKPT_PAGE + 4 * w);
+    snapshot_save(p, words);
+  }
+}
+
+// The snapshot holds one hart's registers over memory the harts share,
+// so it is refused once a second hart has started
+void riscv_isa::snapshot_take() {
+  if (processors_started > 1) {
+    fprintf(stderr, "snapshot: not available with more than one hart\n");
+    return;
+  }
+  snapshot_pages.clear();
+  snapshot_data.clear();
+  memset(snapshot_dirty, 0, sizeof(snapshot_dirty));
+  state_get(snapshot_state);
+  snapshot_active = true;
+}
+
+void riscv_isa::snapshot_reset() {
+  if (!snapshot_active)
+    return;
+  const uint32_t *data = snapshot_data.data();
+  for (size_t i = 0; i < snapshot_pages.size(); i++) {
+    uint32_t p = snapshot_pages[i];
+    for (int w = 0; w < CKPT_PAGE; w += 4)
+      DM.write(p * CKPT_PAGE + w, *data++);
+    snapshot_dirty[p / 64] &= ~(1ULL << (p % 64));
+  }
+  snapshot_pages.clear();
+  snapshot_data.clear();
+  state_set(snapshot_state);
+  snapshot_resets++;
+}
 
 // Generic instruction behavior method
 void ac_behavior(instruction) {
   dbg_printf("---PC=%#x---%lld\n", (int)ac_pc, ac_instr_counter);
+  if (quantum_left && --quantum_left == 0) {
+    quantum_sync(id);
+    quantum_left = quantum;
+  }
+  if (bbv_on && id == 0)
+    bbv_step(ac_pc, compressed_count);
+  if (prof_on && id == 0)
+    prof_step(ac_pc, hpm_event[HPM_VELEMENTS]);
+  if (ac_instr_counter >= instr_event)
+    instr_events();
   ac_pc = ac_pc + 4;
   RB[0] = 0x0;
 }
 
-// Instruction Format behavior methods
-void ac_behavior(Type_R) {}
-void ac_behavior(Type_R4) {}
-void ac_behavior(Type_I) {}
-void ac_behavior(Type_S) {}
-void ac_behavior(Type_SB) {}
+// Instruction Format behavior methods. They also count the instruction
+// class for the performance monitor.
+void ac_behavior(Type_R) { hpm_event[hpm_class[op]]++; }
+void ac_behavior(Type_R4) { hpm_event[HPM_FP]++; }
+void ac_behavior(Type_I) { hpm_event[hpm_class[op]]++; }
+void ac_behavior(Type_S) { hpm_event[HPM_STORE]++; }
+void ac_behavior(Type_SB) { hpm_event[HPM_BRANCH]++; }
 void ac_behavior(Type_U) {}
 void ac_behavior(Type_UJ) {}
-void ac_behavior(Type_V) {}
-void ac_behavior(Type_VM) {}
+void ac_behavior(Type_V) { hpm_event[HPM_VECTOR]++; hpm_event[HPM_VELEMENTS] += vl; }
+void ac_behavior(Type_VM) { hpm_event[HPM_VECTOR]++; }
+
+// Compressed formats: undo half of the generic 4-byte PC advance
+void ac_behavior(Type_CR) { ac_pc = ac_pc - 2; compressed_count++; }
+void ac_behavior(Type_CI) {
+  ac_pc = ac_pc - 2; compressed_count++;
+  hpm_event[hpm_class_ci[(funct3 << 2) | op]]++;
+}
+void ac_behavior(Type_CSS) { ac_pc = ac_pc - 2; compressed_count++; hpm_event[HPM_STORE]++; }
+void ac_behavior(Type_CIW) { ac_pc = ac_pc - 2; compressed_count++; }
+void ac_behavior(Type_CL) { ac_pc = ac_pc - 2; compressed_count++; hpm_event[HPM_LOAD]++; }
+void ac_behavior(Type_CS) { ac_pc = ac_pc - 2; compressed_count++; hpm_event[HPM_STORE]++; }
+void ac_behavior(Type_CA) { ac_pc = ac_pc - 2; compressed_count++; }
+void ac_behavior(Type_CB) { ac_pc = ac_pc - 2; compressed_count++; hpm_event[HPM_BRANCH]++; }
+void ac_behavior(Type_CBI) { ac_pc = ac_pc - 2; compressed_count++; }
+void ac_behavior(Type_CJ) { ac_pc = ac_pc - 2; compressed_count++; }
 
 
 // Behavior called before starting simulation
 void ac_behavior(begin) {
   dbg_printf("@@@ begin behavior @@@\n");
 
+  id = __sync_fetch_and_add(&processors_started, 1);
+  dbg_printf("hart %d\n", (int)id);
+
   for (int regNum = 0; regNum < 32; regNum++) {
     RB[regNum] = 0;
-    RBF[regNum] = 0;
-    RBF[regNum+32] = 0;
+    RBF[regNum].data = 0;
     RBV[regNum] = 0;
     RBV[regNum+32] = 0;
     RBV[regNum+64] = 0;
     RBV[regNum+96] = 0;
   }
+  compressed_count = 0;
+  snapshot_resets = 0;
+  csr_setup();
+  hpm_setup();
+
+  // RISCV_CLOCK_HZ and RISCV_TIMEBASE_HZ give the core clock and the
+  // rate of the time CSR (defaults 1 GHz and 10 MHz)
+  const char *clock = getenv("RISCV_CLOCK_HZ");
+  const char *timebase = getenv("RISCV_TIMEBASE_HZ");
+  clock_hz = clock ? strtoull(clock, NULL, 0) : 0;
+  timebase_hz = timebase ? strtoull(timebase, NULL, 0) : 0;
+  if (!clock_hz)
+    clock_hz = 1000000000;
+  if (!timebase_hz)
+    timebase_hz = 10000000;
+  extra_cycles = 0;
+
+  // RISCV_DETERMINISTIC=1 makes the harts take turns of RISCV_QUANTUM
+  // instructions (1000 unless set). Hart 0 has the first turn; the
+  // others wait for theirs before their first instruction. It needs the
+  // threaded driver.
+  const char *q = getenv("RISCV_QUANTUM");
+  const char *det = getenv("RISCV_DETERMINISTIC");
+  bool deterministic = det && !strcmp(det, "1");
+  quantum = q ? strtoul(q, NULL, 0) : 0;
+  if (!quantum)
+    quantum = 1000;
+  if (deterministic && !riscv_threaded && id == 0)
+    fprintf(stderr, "RISCV_DETERMINISTIC needs riscv_harts.cpp, ignored\n");
+  if (!deterministic || !riscv_threaded)
+    quantum_left = 0;
+  else
+    quantum_left = id == 0 ? quantum + 1 : 1;
+
   fcsr = 0;
   frm = 0;
   fflags = 0;
+  fesetround(FE_TONEAREST);
+  host_round = FE_TONEAREST;
+  feclearexcept(FE_ALL_EXCEPT);
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("fma")) {
+    host_fma_s = fma_hw_s;
+    host_fma_d = fma_hw_d;
+  }
+  if (__builtin_cpu_supports("popcnt"))
+    host_popcount = popcount_hw;
+  if (__builtin_cpu_supports("f16c")) {
+    host_h2f = half_to_float_hw;
+    host_f2h = half_from_float_hw;
+    host_h2f_block = halves_to_floats_hw;
+    host_f2h_block = floats_to_halves_hw;
+  }
+#endif
   vstart = 0;
   vl = 0;
-  vtype = 0;
   vlenb = 16; // VLEN / 8 ( 128 / 8 )
+
+  // RISCV_VTAIL=fast|ones selects the tail-agnostic policy
+  const char *tail = getenv( "RISCV_VTAIL" );
+  vtail_policy = VTAIL_UNDISTURBED;
+  if ( tail && !strcmp( tail, "fast" ) )
+    vtail_policy = VTAIL_FAST;
+  else if ( tail && !strcmp( tail, "ones" ) )
+    vtail_policy = VTAIL_ONES;
+
+  vcfg.raw = ~0;
+  vset_vtype( 0 );
+
+  // RISCV_CBO_BLOCK sets the cache-block size, a power of two (default 64)
+  const char *block = getenv("RISCV_CBO_BLOCK");
+  cbo_block = block ? strtoul(block, NULL, 0) : 64;
+  if (cbo_block < 4 || cbo_block > 4096 || (cbo_block & (cbo_block - 1)))
+    cbo_block = 64;
+  reservation_granule = cbo_block;
+
+  // RISCV_RESTORE=<file> starts from a saved state instead of the
+  // loaded program. Checkpoints hold one hart's registers over memory
+  // the harts share, so like snapshots they need a single hart. Every
+  // hart begins before any runs, so a second one ends the run here.
+  const char *restore = getenv("RISCV_RESTORE");
+  if (id != 0 && (restore || getenv("RISCV_CHECKPOINT"))) {
+    fprintf(stderr, "checkpoint: not available with more than one hart\n");
+    exit(EXIT_FAILURE);
+  }
+  if (restore && !checkpoint_restore(restore))
+    stop(EXIT_FAILURE);
+
+  // RISCV_BBV_INTERVAL is the SimPoint interval in instructions, used
+  // both for the vectors and for the points in RISCV_SIMPOINTS
+  const char *interval = getenv("RISCV_BBV_INTERVAL");
+  if (interval && strtoull(interval, NULL, 0))
+    bbv_interval = strtoull(interval, NULL, 0);
+  const char *bbv = getenv("RISCV_BBV");
+  if (bbv && id == 0) {
+    bbv_file = fopen(bbv, "w");
+    if (!bbv_file)
+      fprintf(stderr, "BBV: cannot create %s\n", bbv);
+    else
+      bbv_left = bbv_interval;
+  }
+
+  // RISCV_PROFILE=<prefix> profiles hart 0 into <prefix>.txt and
+  // <prefix>.folded
+  if (id == 0)
+    prof_prefix = getenv("RISCV_PROFILE");
+
+  // RISCV_ROI_ONLY=1 keeps detailed instrumentation off outside the
+  // regions of interest
+  const char *roi = getenv("RISCV_ROI_ONLY");
+  roi_only = roi && atoi(roi);
+  detail_set(!roi_only);
+  roi_open = false;
+
+  // RISCV_CHECKPOINT=<file> saves the state when the instruction count
+  // reaches RISCV_CHECKPOINT_AT, or at the start of each interval listed
+  // in RISCV_SIMPOINTS. The checkpoint state is hart 0's.
+  checkpoint_at = NO_EVENT;
+  if (id == 0)
+    ckpt_path = getenv("RISCV_CHECKPOINT");
+  const char *at = getenv("RISCV_CHECKPOINT_AT");
+  const char *simpoints = getenv("RISCV_SIMPOINTS");
+  if (ckpt_path && at) {
+    ckpt_point p = { strtoull(at, NULL, 0), -1 };
+    ckpt_points.push_back(p);
+  } else if (ckpt_path && simpoints && roi_only) {
+    // Intervals would count region instructions only, checkpoints all
+    fprintf(stderr, "checkpoint: RISCV_SIMPOINTS cannot be used with RISCV_ROI_ONLY\n");
+    stop(EXIT_FAILURE);
+  } else if (ckpt_path && simpoints && !ckpt_read_simpoints(simpoints, bbv_interval)) {
+    fprintf(stderr, "checkpoint: cannot read %s\n", simpoints);
+  }
+  if (ckpt_path && !ckpt_points.empty())
+    checkpoint_at = ckpt_points[0].at;
+
+  // RISCV_SAMPLE=<n> runs n instructions, usually from a checkpoint,
+  // and reports the counters over them
+  const char *sample = getenv("RISCV_SAMPLE");
+  sample_end = sample ? ac_instr_counter + strtoull(sample, NULL, 0) : NO_EVENT;
+  stats_mark(sample_stats);
+  instr_event = 0;
 }
 
 
 // Behavior called after finishing simulation
 void ac_behavior(end) {
   dbg_printf("@@@ end behavior @@@\n");
+  if (quantum_left)
+    quantum_leave(id);
+  if (roi_open)
+    roi_end(roi_id);
+  if (prof_prefix && id == 0)
+    prof_report();
+  if (bbv_file && id == 0) {
+    bbv_flush();
+    fclose(bbv_file);
+    bbv_file = NULL;
+  }
+  if (compressed_count)
+    fprintf(stderr, "RV32C: %llu compressed instructions, %llu fetch bytes saved\n",
+            compressed_count, 2 * compressed_count);
 }
 
 // Instruction ADD behavior method. (no check for overflow)
@@ -341,6 +1742,10 @@ void ac_behavior(JALR) {
   if (rd != 0)
     RB[rd] = ac_pc;
   ac_pc = target_addr;
+  if (rd == Ra)
+    prof_call(target_addr);
+  else if (rd == 0 && rs1 == Ra)
+    prof_return();
   dbg_printf("Target = %#x\n", (ac_pc & 0xF0000000) | target_addr);
   dbg_printf("Target = %#x\n", target_addr);
   dbg_printf("Return = %#x\n\n", RB[rd]);
@@ -396,24 +1801,44 @@ void ac_behavior(SBREAK) {
 // Instruction RDCYCLE behavior method.
 void ac_behavior(RDCYCLE) {
   dbg_printf("RDCYCLE r%d\n", rd);
-  RB[rd] = ac_pc;
+  RB[rd] = csr_read(0xC00);
   dbg_printf("Result = %#x\n", RB[rd]);
 }
 
 // Instruction RDCYCLEH behavior method.
-void ac_behavior(RDCYCLEH) { dbg_printf("RDCYCLEH r%d\n", rd); }
+void ac_behavior(RDCYCLEH) {
+  dbg_printf("RDCYCLEH r%d\n", rd);
+  RB[rd] = csr_read(0xC80);
+  dbg_printf("Result = %#x\n", RB[rd]);
+}
 
 // Instruction RDTIME behavior method.
-void ac_behavior(RDTIME) { dbg_printf("RDTIME r%d\n", rd); }
+void ac_behavior(RDTIME) {
+  dbg_printf("RDTIME r%d\n", rd);
+  RB[rd] = csr_read(0xC01);
+  dbg_printf("Result = %#x\n", RB[rd]);
+}
 
 // Instruction RDTIMEH behavior method.
-void ac_behavior(RDTIMEH) { dbg_printf("RDTIMEH r%d\n", rd); }
+void ac_behavior(RDTIMEH) {
+  dbg_printf("RDTIMEH r%d\n", rd);
+  RB[rd] = csr_read(0xC81);
+  dbg_printf("Result = %#x\n", RB[rd]);
+}
 
 // Instruction RDINSTRET behavior method.
-void ac_behavior(RDINSTRET) { dbg_printf("RDINSTRET r%d\n", rd); }
+void ac_behavior(RDINSTRET) {
+  dbg_printf("RDINSTRET r%d\n", rd);
+  RB[rd] = csr_read(0xC02);
+  dbg_printf("Result = %#x\n", RB[rd]);
+}
 
 // Instruction RDINSTRETH behavior method.
-void ac_behavior(RDINSTRETH) { dbg_printf("RDINSTRETH r%d\n", rd); }
+void ac_behavior(RDINSTRETH) {
+  dbg_printf("RDINSTRETH r%d\n", rd);
+  RB[rd] = csr_read(0xC82);
+  dbg_printf("Result = %#x\n", RB[rd]);
+}
 
 // Instruction FENCE behavior method.
 void ac_behavior(FENCE) { dbg_printf("FENCE r%d\n", rd); }
@@ -421,33 +1846,106 @@ void ac_behavior(FENCE) { dbg_printf("FENCE r%d\n", rd); }
 // Instruction FENCE_I behavior method.
 void ac_behavior(FENCE_I) { dbg_printf("FENCE_I r%d\n", rd); }
 
+// There is no cache in the functional model, so the management operations
+// only name the block they act on.
+
+// Instruction CBO.INVAL behavior method.
+void ac_behavior(CBO_INVAL) {
+  dbg_printf("CBO.INVAL block %#x\n", RB[rs1] & ~(cbo_block - 1));
+  cbo_notify(CBO_OP_INVAL, RB[rs1] & ~(cbo_block - 1));
+}
+
+// Instruction CBO.CLEAN behavior method.
+void ac_behavior(CBO_CLEAN) {
+  dbg_printf("CBO.CLEAN block %#x\n", RB[rs1] & ~(cbo_block - 1));
+  cbo_notify(CBO_OP_CLEAN, RB[rs1] & ~(cbo_block - 1));
+}
+
+// Instruction CBO.FLUSH behavior method.
+void ac_behavior(CBO_FLUSH) {
+  dbg_printf("CBO.FLUSH block %#x\n", RB[rs1] & ~(cbo_block - 1));
+  cbo_notify(CBO_OP_FLUSH, RB[rs1] & ~(cbo_block - 1));
+}
+
+// Instruction CBO.ZERO behavior method. Zeroes the whole aligned block.
+void ac_behavior(CBO_ZERO) {
+  ac_word base = RB[rs1] & ~(cbo_block - 1);
+  dbg_printf("CBO.ZERO block %#x\n", base);
+  store_check(base, cbo_block);
+  for (ac_word offset = 0; offset < cbo_block; offset += 4)
+    DM.write(base + offset, 0);
+  cbo_notify(CBO_OP_ZERO, base);
+}
+
 // Instruction CSRRW behavior method.
 void ac_behavior(CSRRW) {
  dbg_printf("CSRRW csr:%d\n", csr);
- ac_word tmp = RB[rd];
- ac_reg<riscv_parms::ac_word> mapped = csr_map(csr);
+ ac_word tmp = RB[rs1];
+ if (csr <= 0x3)
+  sync_fflags();
  if(rd != 0x0){
-  RB[rd] = mapped;
+  RB[rd] = csr_read(csr);
  }
- mapped = tmp;
+ csr_write(csr, tmp);
 }
 
 // Instruction CSRRS behavior method.
 void ac_behavior(CSRRS) {
  dbg_printf("CSRRS csr:%d\n", csr);
- ac_reg<riscv_parms::ac_word> mapped = csr_map(csr);
- ac_word tmp = RB[rd];
- RB[rd] = mapped;
- mapped |= tmp;
+ ac_word tmp = RB[rs1];
+ if (csr <= 0x3)
+  sync_fflags();
+ ac_word old = csr_read(csr);
+ RB[rd] = old;
+ if (rs1 != 0x0)
+  csr_write(csr, old | tmp);
 }
 
 // Instruction CSRRC behavior method.
 void ac_behavior(CSRRC) {
  dbg_printf("CSRRC csr:%d\n", csr);
- ac_reg<riscv_parms::ac_word> mapped = csr_map(csr);
- ac_word tmp = RB[rd];
- RB[rd] = mapped;
- mapped &= ~tmp;
+ ac_word tmp = RB[rs1];
+ if (csr <= 0x3)
+  sync_fflags();
+ ac_word old = csr_read(csr);
+ RB[rd] = old;
+ if (rs1 != 0x0)
+  csr_write(csr, old & ~tmp);
+}
+
+// The immediate forms take a 5-bit zero-extended value in the rs1 field.
+
+// Instruction CSRRWI behavior method.
+void ac_behavior(CSRRWI) {
+ dbg_printf("CSRRWI csr:%d\n", csr);
+ if (csr <= 0x3)
+  sync_fflags();
+ if(rd != 0x0){
+  RB[rd] = csr_read(csr);
+ }
+ csr_write(csr, rs1);
+}
+
+// Instruction CSRRSI behavior method.
+void ac_behavior(CSRRSI) {
+ dbg_printf("CSRRSI csr:%d\n", csr);
+ if (csr <= 0x3)
+  sync_fflags();
+ ac_word old = csr_read(csr);
+ RB[rd] = old;
+ if (rs1 != 0x0)
+  csr_write(csr, old | rs1);
+}
+
+// Instruction CSRRCI behavior method.
+void ac_behavior(CSRRCI) {
+ dbg_printf("CSRRCI csr:%d\n", csr);
+ if (csr <= 0x3)
+  sync_fflags();
+ ac_word old = csr_read(csr);
+ RB[rd] = old;
+ if (rs1 != 0x0)
+  csr_write(csr, old & ~rs1);
 }
 
 // Instruction SB behavior method
@@ -458,6 +1956,7 @@ void ac_behavior(SB) {
   unsigned char byte = RB[rs2] & 0xFF;
   int sign_ext;
   sign_ext = sign_extend(imm, 12);
+  store_check(RB[rs1] + sign_ext, 1);
   DM.write_byte(RB[rs1] + sign_ext, byte);
   dbg_printf("addr: %#x\n", RB[rs1] + sign_ext);
   dbg_printf("Result: %#x\n\n\n", byte);
@@ -471,6 +1970,7 @@ void ac_behavior(SH) {
   int sign_ext;
   sign_ext = sign_extend(imm, 12);
   unsigned short int half = RB[rs2] & 0xFFFF;
+  store_check(RB[rs1] + sign_ext, 2);
   DM.write_half(RB[rs1] + sign_ext, half);
   dbg_printf("addr: %#x\n", RB[rs1] + sign_ext);
   dbg_printf("Result: %#x\n\n\n", half);
@@ -483,6 +1983,7 @@ void ac_behavior(SW) {
   dbg_printf("SW r%d, r%d, %d\n", rs1, rs2, imm);
   int sign_ext;
   sign_ext = sign_extend(imm, 12);
+  store_check(RB[rs1] + sign_ext, 4);
   DM.write(RB[rs1] + sign_ext, RB[rs2]);
   dbg_printf("addr: %d\n\n", RB[rs1] + sign_ext);
 }
@@ -499,6 +2000,7 @@ void ac_behavior(BEQ) {
     addr = ac_pc + (imm << 1) - 4;
   if (RB[rs1] == RB[rs2]) {
     ac_pc = addr;
+    hpm_event[HPM_TAKEN]++;
     dbg_printf("---Branch Taken--- to %#x\n\n", addr);
   } else
     dbg_printf("---Branch not Taken---\n\n");
@@ -516,6 +2018,7 @@ void ac_behavior(BNE) {
     addr = ac_pc + (imm << 1) - 4;
   if (RB[rs1] != RB[rs2]) {
     ac_pc = addr;
+    hpm_event[HPM_TAKEN]++;
     dbg_printf("---Branch Taken---\n\n");
   } else
     dbg_printf("---Branch not Taken---\n\n");
@@ -537,6 +2040,7 @@ void ac_behavior(BLT) {
   dbg_printf("rs2 = %#x\n", RB[rs2]);
   if ((ac_Sword)RB[rs1] < (ac_Sword)RB[rs2]) {
     ac_pc = addr;
+    hpm_event[HPM_TAKEN]++;
     dbg_printf("---Branch Taken---\n\n");
   } else
     dbg_printf("---Branch not Taken---\n\n");
@@ -554,6 +2058,7 @@ void ac_behavior(BGE) {
     addr = ac_pc + (imm << 1) - 4;
   if ((ac_Sword)RB[rs1] >= (ac_Sword)RB[rs2]) {
     ac_pc = addr;
+    hpm_event[HPM_TAKEN]++;
     dbg_printf("---Branch Taken---\n\n");
   } else
     dbg_printf("---Branch not Taken---\n\n");
@@ -571,6 +2076,7 @@ void ac_behavior(BLTU) {
     addr = ac_pc + (imm << 1) - 4;
   if ((ac_Uword)RB[rs1] < (ac_Uword)RB[rs2]) {
     ac_pc = addr;
+    hpm_event[HPM_TAKEN]++;
     dbg_printf("---Branch Taken---\n\n");
   } else
     dbg_printf("---Branch not Taken---\n\n");
@@ -589,6 +2095,7 @@ void ac_behavior(BGEU) {
   if (((ac_Uword)RB[rs1] > (ac_Uword)RB[rs2]) ||
       ((ac_Uword)RB[rs1] == (ac_Uword)RB[rs2])) {
     ac_pc = addr;
+    hpm_event[HPM_TAKEN]++;
     dbg_printf("---Branch Taken---\n\n");
   } else
     dbg_printf("---Branch not Taken---\n\n");
@@ -623,6 +2130,8 @@ void ac_behavior(JAL) {
   if (rd != 0)
     RB[rd] = ac_pc;
   ac_pc = (ac_pc & 0xF0000000) | addr;
+  if (rd == Ra)
+    prof_call(ac_pc);
   dbg_printf("--- Jump taken ---\n\n");
 }
 
@@ -738,115 +2247,121 @@ void ac_behavior(REMU) {
   dbg_printf("Result = %#x\n\n", (ac_Uword)RB[rd]);
 }
 
-// Instruction LR.W behavior method
-void ac_behavior(LR_W) { RB[rd] = DM.read(RB[rs1]); }
+// Instruction LR.W behavior method. The reservation is published before
+// the load, so a store that misses it writes after the load and makes
+// the SC's compare-and-swap fail.
+void ac_behavior(LR_W) {
+  dbg_printf("LR.W r%d, r%d\n", rd, rs1);
+  ac_word addr = RB[rs1];
+  if (id < MAX_HARTS && !reservation[id].exchange((addr & ~(cbo_block - 1)) | 1))
+    reservations_held++;
+  RB[rd] = amo_load(addr);
+  if (id < MAX_HARTS)
+    reserved_value[id] = RB[rd];
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
 
-// Instruction SC.w behavior method
+// Instruction SC.W behavior method. Succeeds only while this hart still
+// holds the reservation LR.W took on the granule and the word still
+// holds the value LR.W loaded.
 void ac_behavior(SC_W) {
-  DM.write(RB[rs1], RB[rs2]);
-  RB[rd] = 0; // indicating success
+  dbg_printf("SC.W r%d, r%d, r%d\n", rd, rs1, rs2);
+  ac_word addr = RB[rs1];
+  bool held = false;
+  if (id < MAX_HARTS) {
+    ac_word r = reservation[id].load();
+    held = reservation_drop(id, r) && r == ((addr & ~(cbo_block - 1)) | 1);
+  }
+  if (held) {
+    store_check(addr, 4);
+    held = amo_cas(addr, reserved_value[id], RB[rs2]);
+  }
+  RB[rd] = held ? 0 : 1;
+  dbg_printf("Result = %d\n\n", RB[rd]);
 }
 
+// The AMOs read both operands before writing rd, which may be rs2, and
+// do the read-modify-write as one host atomic in amo_rmw.
+
 // Instruction AMOSWAP.W behavior method
 void ac_behavior(AMOSWAP_W) {
   dbg_printf("AMOSWAP.W r%d, r%d, r%d\n", rd, rs1, rs2);
-  RB[rd] = DM.read(RB[rs1]);
-  dbg_printf("RB[rd] = %d\n", RB[rd]);
-  dbg_printf("RB[rs2] = %d\n", RB[rs2]);
-  int temp;
-  temp = RB[rs2];
-  RB[rs2] = RB[rd];
-  RB[rd] = temp;
-  dbg_printf("After swapping RB[rd] = %d\n\n", RB[rd]);
-  DM.write(RB[rs1], RB[rd]);
+  ac_word addr = RB[rs1], src = RB[rs2];
+  store_check(addr, 4);
+  RB[rd] = amo_rmw(AMO_SWAP, addr, src);
+  dbg_printf("RB[rd] = %d\n\n", RB[rd]);
 }
 
 // Instruction AMOADD.W behavior method
 void ac_behavior(AMOADD_W) {
   dbg_printf("AMOADD.W r%d, r%d, r%d\n", rd, rs1, rs2);
-  RB[rd] = DM.read(RB[rs1]);
-  dbg_printf("RB[rd] = %d\n", RB[rd]);
-  dbg_printf("RB[rs2] = %d\n", RB[rs2]);
-  DM.write(RB[rs1], ((ac_Sword)RB[rd] + (ac_Sword)RB[rs2]));
-  dbg_printf("Result = %d\n\n", RB[rd] + RB[rs2]);
+  ac_word addr = RB[rs1], src = RB[rs2];
+  store_check(addr, 4);
+  RB[rd] = amo_rmw(AMO_ADD, addr, src);
+  dbg_printf("RB[rd] = %d\n\n", RB[rd]);
 }
 
 // Instruction AMOXOR.W behavior method
 void ac_behavior(AMOXOR_W) {
   dbg_printf("AMOXOR.W r%d, r%d, r%d\n", rd, rs1, rs2);
-  RB[rd] = DM.read(RB[rs1]);
-  dbg_printf("RB[rd] = %d\n", RB[rd]);
-  dbg_printf("RB[rs2] = %d\n", RB[rs2]);
-  DM.write(RB[rs1], (RB[rd] ^ RB[rs2]));
-  dbg_printf("Result = %d\n\n", RB[rd] ^ RB[rs2]);
+  ac_word addr = RB[rs1], src = RB[rs2];
+  store_check(addr, 4);
+  RB[rd] = amo_rmw(AMO_XOR, addr, src);
+  dbg_printf("RB[rd] = %d\n\n", RB[rd]);
 }
 
 // Instruction AMOAND.W behavior method
 void ac_behavior(AMOAND_W) {
   dbg_printf("AMOAND.W r%d, r%d, r%d\n", rd, rs1, rs2);
-  RB[rd] = DM.read(RB[rs1]);
-  dbg_printf("RB[rd] = %d\n", RB[rd]);
-  dbg_printf("RB[rs2] = %d\n", RB[rs2]);
-  DM.write(RB[rs1], (RB[rd] & RB[rs2]));
-  dbg_printf("Result = %d\n\n", RB[rd] & RB[rs2]);
+  ac_word addr = RB[rs1], src = RB[rs2];
+  store_check(addr, 4);
+  RB[rd] = amo_rmw(AMO_AND, addr, src);
+  dbg_printf("RB[rd] = %d\n\n", RB[rd]);
 }
 
 // Instruction AMOOR.W behavior method
 void ac_behavior(AMOOR_W) {
   dbg_printf("AMOOR.W r%d, r%d, r%d\n", rd, rs1, rs2);
-  RB[rd] = DM.read(RB[rs1]);
-  dbg_printf("RB[rd] = %d\n", RB[rd]);
-  dbg_printf("RB[rs2] = %d\n", RB[rs2]);
-  DM.write(RB[rs1], (RB[rd] | RB[rs2]));
-  dbg_printf("Result = %d\n\n", RB[rd] | RB[rs2]);
+  ac_word addr = RB[rs1], src = RB[rs2];
+  store_check(addr, 4);
+  RB[rd] = amo_rmw(AMO_OR, addr, src);
+  dbg_printf("RB[rd] = %d\n\n", RB[rd]);
 }
 
 // Instruction AMOMIN.W behavior method
 void ac_behavior(AMOMIN_W) {
   dbg_printf("AMOMIN.W r%d, r%d, r%d\n", rd, rs1, rs2);
-  RB[rd] = DM.read(RB[rs1]);
-  dbg_printf("RB[rd] = %d\n", RB[rd]);
-  dbg_printf("RB[rs2] = %d\n", RB[rs2]);
-  if (RB[rd] < RB[rs2])
-    DM.write(RB[rs1], RB[rd]);
-  else
-    DM.write(RB[rs1], RB[rs2]);
+  ac_word addr = RB[rs1], src = RB[rs2];
+  store_check(addr, 4);
+  RB[rd] = amo_rmw(AMO_MIN, addr, src);
+  dbg_printf("RB[rd] = %d\n\n", RB[rd]);
 }
 
 // Instruction AMOMAX.W behavior method
 void ac_behavior(AMOMAX_W) {
   dbg_printf("AMOMAX.W r%d, r%d, r%d\n", rd, rs1, rs2);
-  RB[rd] = DM.read(RB[rs1]);
-  dbg_printf("RB[rd] = %d\n", RB[rd]);
-  dbg_printf("RB[rs2] = %d\n\n", RB[rs2]);
-  if (RB[rd] > RB[rs2])
-    DM.write(RB[rs1], RB[rd]);
-  else
-    DM.write(RB[rs1], RB[rs2]);
+  ac_word addr = RB[rs1], src = RB[rs2];
+  store_check(addr, 4);
+  RB[rd] = amo_rmw(AMO_MAX, addr, src);
+  dbg_printf("RB[rd] = %d\n\n", RB[rd]);
 }
 
 // Instruction AMOMINU.W behavior method
 void ac_behavior(AMOMINU_W) {
   dbg_printf("AMOMINU.W r%d, r%d, r%d\n", rd, rs1, rs2);
-  RB[rd] = DM.read(RB[rs1]);
-  dbg_printf("RB[rd] = %d\n", RB[rd]);
-  dbg_printf("RB[rs2] = %d\n\n", RB[rs2]);
-  if ((ac_Uword)RB[rd] < (ac_Uword)RB[rs2])
-    DM.write(RB[rs1], RB[rd]);
-  else
-    DM.write(RB[rs1], RB[rs2]);
+  ac_word addr = RB[rs1], src = RB[rs2];
+  store_check(addr, 4);
+  RB[rd] = amo_rmw(AMO_MINU, addr, src);
+  dbg_printf("RB[rd] = %d\n\n", RB[rd]);
 }
 
 // Instruction AMOMAXU.W behavior method
 void ac_behavior(AMOMAXU_W) {
   dbg_printf("AMOMAXU.W r%d, r%d, r%d\n", rd, rs1, rs2);
-  RB[rd] = DM.read(RB[rs1]);
-  dbg_printf("RB[rd] = %d\n", RB[rd]);
-  dbg_printf("RB[rs2] = %d\n", RB[rs2]);
-  if ((ac_Uword)RB[rd] > (ac_Uword)RB[rs2])
-    DM.write(RB[rs1], RB[rd]);
-  else
-    DM.write(RB[rs1], RB[rs2]);
+  ac_word addr = RB[rs1], src = RB[rs2];
+  store_check(addr, 4);
+  RB[rd] = amo_rmw(AMO_MAXU, addr, src);
+  dbg_printf("RB[rd] = %d\n\n", RB[rd]);
 }
 
 // Instruction FLW behavior method
@@ -856,10 +2371,10 @@ void ac_behavior(FLW) {
   dbg_printf("FLW r%d, r%d, %d\n", rd, rs1, offset);
   int sign_ext;
   sign_ext = sign_extend(offset, 12);
-  RBF[rd] = DM.read(RB[rs1] + sign_ext);
+  save_float_bits(DM.read(RB[rs1] + sign_ext), rd);
   dbg_printf("RB[rs1] = %#x\n", RB[rs1]);
   dbg_printf("addr = %#x\n", RB[rs1] + sign_ext);
-  dbg_printf("Result = %.3f\n\n", (float)RBF[rd]);
+  dbg_printf("Result = %.3f\n\n", load_float(rd));
 }
 
 // Instruction FSW behavior method
@@ -869,13 +2384,15 @@ void ac_behavior(FSW) {
   dbg_printf("FSW r%d, r%d, %d\n", rs1, rs2, imm);
   int sign_ext;
   sign_ext = sign_extend(imm, 12);
-  DM.write(RB[rs1] + sign_ext, RBF[rs2]);
+  store_check(RB[rs1] + sign_ext, 4);
+  DM.write(RB[rs1] + sign_ext, RBF[rs2].w[0]);
   dbg_printf("addr: %d\n\n", RB[rs1] + sign_ext);
 }
 
 // Instruction FADD.S behavior method
 void ac_behavior(FADD_S) {
   dbg_printf("FADD.S r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_float(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs2));
   float sum;
@@ -887,6 +2404,7 @@ void ac_behavior(FADD_S) {
 // Instruction FSUB.S behavior method
 void ac_behavior(FSUB_S) {
   dbg_printf("FSUB.S r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_float(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs2));
   float diff;
@@ -898,6 +2416,7 @@ void ac_behavior(FSUB_S) {
 // Instruction FMUL.S behavior method
 void ac_behavior(FMUL_S) {
   dbg_printf("FMUL.S r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_float(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs2));
   float product;
@@ -909,6 +2428,7 @@ void ac_behavior(FMUL_S) {
 // Instruction FDIV.S behavior method
 void ac_behavior(FDIV_S) {
   dbg_printf("FDIV.S r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_float(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs2));
   float quot;
@@ -952,24 +2472,21 @@ void ac_behavior(FMAX_S) {
 // Instruction FSQRT.S behavior method
 void ac_behavior(FSQRT_S) {
   dbg_printf("FSQRT.S r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_float(rs1));
-  float temp;
-  if (load_float(rs1) < 0) {
-    dbg_printf("Invalid!");
-    stop();
-  } else
-    RBF[rd] = sqrt(RBF[rs1]);
-  dbg_printf("Result = %.3f\n\n", (float)RBF[rd]);
+  save_float(sqrtf(load_float(rs1)), rd);
+  dbg_printf("Result = %.3f\n\n", load_float(rd));
 }
 
 // Instruction FMADD.S behavior method
 void ac_behavior(FMADD_S) {
   dbg_printf("FMADD.S r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_float(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs2));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs3));
   float res;
-  res = load_float(rs1) * load_float(rs2) + load_float(rs3);
+  res = host_fma_s(load_float(rs1), load_float(rs2), load_float(rs3));
   save_float(res, rd);
   dbg_printf("Result = %.3f\n\n", res);
 }
@@ -977,11 +2494,12 @@ void ac_behavior(FMADD_S) {
 // Instruction FMSUB.S behavior method
 void ac_behavior(FMSUB_S) {
   dbg_printf("FMSUB.S r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_float(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs2));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs3));
   float res;
-  res = load_float(rs1) * load_float(rs2) - load_float(rs3);
+  res = host_fma_s(load_float(rs1), load_float(rs2), -load_float(rs3));
   save_float(res, rd);
   dbg_printf("Result = %.3f\n\n", res);
 }
@@ -989,11 +2507,12 @@ void ac_behavior(FMSUB_S) {
 // Instruction FNMSUB.S behavior method
 void ac_behavior(FNMSUB_S) {
   dbg_printf("FNMSUB.S r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_float(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs2));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs3));
   float res;
-  res = (-(load_float(rs1) * load_float(rs2) - load_float(rs3)));
+  res = host_fma_s(-load_float(rs1), load_float(rs2), load_float(rs3));
   save_float(res, rd);
   dbg_printf("Result = %.3f\n\n", res);
 }
@@ -1001,11 +2520,12 @@ void ac_behavior(FNMSUB_S) {
 // Instruction FNMADD.S behavior method
 void ac_behavior(FNMADD_S) {
   dbg_printf("FNMADD.S r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_float(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs2));
   dbg_printf("RBF[rs2] = %.3f\n", load_float(rs3));
   float res;
-  res = (-(load_float(rs1) * load_float(rs2) + load_float(rs3)));
+  res = host_fma_s(-load_float(rs1), load_float(rs2), -load_float(rs3));
   save_float(res, rd);
   dbg_printf("Result = %.3f\n\n", res);
 }
@@ -1013,22 +2533,31 @@ void ac_behavior(FNMADD_S) {
 // Instruction FCVT.W.S behavior method
 void ac_behavior(FCVT_W_S) {
   dbg_printf("FCVT.W.S r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %f\n", load_float(rs1));
-  RB[rd] = round(load_float(rs1));
+  ac_word flags = 0;
+  RB[rd] = fcvt_int(load_float(rs1), -2147483648.0, 2147483647.0, flags);
+  if (flags)
+    fflags = fflags | flags;
   dbg_printf("RB[rd] = %d \n \n", RB[rd]);
 }
 
 // Instruction FCVT.WU.S behavior method
 void ac_behavior(FCVT_WU_S) {
   dbg_printf("FCVT.WU.S r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %f\n", load_float(rs1));
-  RB[rd] = (unsigned int)(load_float(rs1));
+  ac_word flags = 0;
+  RB[rd] = fcvt_int(load_float(rs1), 0.0, 4294967295.0, flags);
+  if (flags)
+    fflags = fflags | flags;
   dbg_printf("RB[rd] = %d \n \n", RB[rd]);
 }
 
 // Instruction FCVT.S.W behaior method
 void ac_behavior(FCVT_S_W) {
   dbg_printf("FCVT.S.W r%d, r%d \n", rd, rs1);
+  fp_round(funct3);
   dbg_printf("RB[rs1] = %d \n", RB[rs1]);
   float temp;
   ac_Sword b = RB[rs1];
@@ -1039,6 +2568,7 @@ void ac_behavior(FCVT_S_W) {
 // Instruction FCVT_S_WU behaior method
 void ac_behavior(FCVT_S_WU) {
   dbg_printf("FCVT.S.W r%d, r%d \n", rd, rs1);
+  fp_round(funct3);
   dbg_printf("RB[rs1] = %d \n", RB[rs1]);
   float temp;
   ac_Uword b = RB[rs1];
@@ -1109,7 +2639,7 @@ void ac_behavior(FSGNJX_D) {
 void ac_behavior(FMV_X_S) {
   dbg_printf("FMV.X.S r%d, r%d \n", rd, rs1);
   dbg_printf("RBF[rs1] = %f \n", load_float(rs1));
-  memcpy(&RB[rd], &RBF[rs1], sizeof(uint32_t));
+  RB[rd] = RBF[rs1].w[0];
   // RB[rd] = (int)load_float(rs1);
   dbg_printf("RB[rd] = %d \n \n", RB[rd]);
 }
@@ -1118,7 +2648,7 @@ void ac_behavior(FMV_X_S) {
 void ac_behavior(FMV_S_X) {
   dbg_printf("FMV.S.X r%d, r%d \n", rd, rs1);
   dbg_printf("RB[rs1] = %d \n", RB[rs1]);
-  memcpy(&RBF[rd], &RB[rs1], sizeof(uint32_t));
+  save_float_bits(RB[rs1], rd);
   // save_float(RB[rs1], rd);
   dbg_printf("RBF[rd] = %f \n \n", load_float(rd));
 }
@@ -1128,10 +2658,8 @@ void ac_behavior(FEQ_S) {
   dbg_printf("FEQ.S r%d, r%d, r%d \n", rd, rs1, rs2);
   dbg_printf("RBF[rs1] = %f \n", load_float(rs1));
   dbg_printf("RBF[rs2] = %f \n", load_float(rs2));
-  if ((custom_isnan(load_float(rs1)) == 1) || (custom_isnan(load_float(rs2)) == 1)) {
-    printf("Invalid Operation\n");
-    RB[rd] = 0;
-  }
+  if (is_snan(load_float(rs1)) || is_snan(load_float(rs2)))
+    fflags = fflags | 0x10;
   if (load_float(rs1) == load_float(rs2))
     RB[rd] = 1;
   else
@@ -1144,10 +2672,8 @@ void ac_behavior(FLE_S) {
   dbg_printf("FLE.S r%d, r%d, r%d \n", rd, rs1, rs2);
   dbg_printf("RBF[rs1] = %f \n", load_float(rs1));
   dbg_printf("RBF[rs2] = %f \n", load_float(rs2));
-  if ((custom_isnan(load_float(rs1)) == 1) || (custom_isnan(load_float(rs2)) == 1)) {
-    printf("Invalid Operation\n");
-    RB[rd] = 0;
-  }
+  if (custom_isnan(load_float(rs1)) || custom_isnan(load_float(rs2)))
+    fflags = fflags | 0x10;
   if (load_float(rs1) <= load_float(rs2))
     RB[rd] = 1;
   else
@@ -1160,10 +2686,8 @@ void ac_behavior(FLT_S) {
   dbg_printf("FLT.S r%d, r%d, r%d \n", rd, rs1, rs2);
   dbg_printf("RBF[rs1] = %f \n", load_float(rs1));
   dbg_printf("RBF[rs2] = %f \n", load_float(rs2));
-  if ((custom_isnan(load_float(rs1)) == 1) || (custom_isnan(load_float(rs2)) == 1)) {
-    printf("Invalid Operation\n");
-    RB[rd] = 0;
-  }
+  if (custom_isnan(load_float(rs1)) || custom_isnan(load_float(rs2)))
+    fflags = fflags | 0x10;
   if (load_float(rs1) < load_float(rs2))
     RB[rd] = 1;
   else
@@ -1186,8 +2710,8 @@ void ac_behavior(FLD) {
   dbg_printf("FLD r%d, r%d, %d\n", rd, rs1, imm);
   int sign_ext;
   sign_ext = sign_extend(imm, 12);
-  RBF[rd * 2] = DM.read(RB[rs1] + sign_ext);
-  RBF[rd * 2 + 1] = DM.read(RB[rs1] + sign_ext + 4);
+  RBF[rd].w[0] = DM.read(RB[rs1] + sign_ext);
+  RBF[rd].w[1] = DM.read(RB[rs1] + sign_ext + 4);
   dbg_printf("RB[rs1] = %#x\n", RB[rs1]);
   dbg_printf("addr = %#x\n", RB[rs1] + sign_ext);
   double temp = load_double(rd);
@@ -1201,14 +2725,16 @@ void ac_behavior(FSD) {
   dbg_printf("FSD r%d, r%d, %d\n", rs1, rs2, imm);
   int sign_ext;
   sign_ext = sign_extend(imm, 12);
-  DM.write(RB[rs1] + sign_ext, RBF[rs2 * 2]);
-  DM.write(RB[rs1] + sign_ext + 4, RBF[rs2 * 2 + 1]);
+  store_check(RB[rs1] + sign_ext, 8);
+  DM.write(RB[rs1] + sign_ext, RBF[rs2].w[0]);
+  DM.write(RB[rs1] + sign_ext + 4, RBF[rs2].w[1]);
   dbg_printf("addr: %d\n\n", RB[rs1] + sign_ext);
 }
 
 // Instruction FADD.D behavior method
 void ac_behavior(FADD_D) {
   dbg_printf("FADD.D r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_double(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs2));
   double sum;
@@ -1220,6 +2746,7 @@ void ac_behavior(FADD_D) {
 // Instruction FSUB.D behavior method
 void ac_behavior(FSUB_D) {
   dbg_printf("FSUB.D r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_double(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs2));
   double diff;
@@ -1231,6 +2758,7 @@ void ac_behavior(FSUB_D) {
 // Instruction FMUL.D behavior method
 void ac_behavior(FMUL_D) {
   dbg_printf("FMUL.D r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_double(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs2));
   double product;
@@ -1242,6 +2770,7 @@ void ac_behavior(FMUL_D) {
 // Instruction FDIV.D behavior method
 void ac_behavior(FDIV_D) {
   dbg_printf("FDIV.D r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_double(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs2));
   double quot;
@@ -1285,26 +2814,23 @@ void ac_behavior(FMAX_D) {
 // Instruction FSQRT.D behavior method
 void ac_behavior(FSQRT_D) {
   dbg_printf("FSQRT.D r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_double(rs1));
   double temp;
-  if (load_double(rs1) < 0) {
-    dbg_printf("Invalid!");
-    stop();
-  } else {
-    temp = sqrt(load_double(rs1));
-    save_double(temp, rd);
-  }
+  temp = sqrt(load_double(rs1));
+  save_double(temp, rd);
   dbg_printf("Result = %.3f\n\n", temp);
 }
 
 // Instruction FMADD.D behavior method
 void ac_behavior(FMADD_D) {
   dbg_printf("FMADD.D r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_double(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs2));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs3));
   double res;
-  res = load_double(rs1) * load_double(rs2) + load_double(rs3);
+  res = host_fma_d(load_double(rs1), load_double(rs2), load_double(rs3));
   save_double(res, rd);
   dbg_printf("Result = %.3f\n\n", res);
 }
@@ -1312,11 +2838,12 @@ void ac_behavior(FMADD_D) {
 // Instruction FMSUB.D behavior method
 void ac_behavior(FMSUB_D) {
   dbg_printf("FMSUB.D r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_double(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs2));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs3));
   double res;
-  res = load_double(rs1) * load_double(rs2) - load_double(rs3);
+  res = host_fma_d(load_double(rs1), load_double(rs2), -load_double(rs3));
   save_double(res, rd);
   dbg_printf("Result = %.3f\n\n", res);
 }
@@ -1324,11 +2851,12 @@ void ac_behavior(FMSUB_D) {
 // Instruction FNMSUB.D behavior method
 void ac_behavior(FNMSUB_D) {
   dbg_printf("FNMSUB.D r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_double(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs2));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs3));
   double res;
-  res = (-(load_double(rs1) * load_double(rs2) - load_double(rs3)));
+  res = host_fma_d(-load_double(rs1), load_double(rs2), load_double(rs3));
   save_double(res, rd);
   dbg_printf("Result = %.3f\n\n", res);
 }
@@ -1336,11 +2864,12 @@ void ac_behavior(FNMSUB_D) {
 // Instruction FNMADD.D behavior method
 void ac_behavior(FNMADD_D) {
   dbg_printf("FNMADD.D r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %.3f\n", load_double(rs1));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs2));
   dbg_printf("RBF[rs2] = %.3f\n", load_double(rs3));
   double res;
-  res = (-(load_double(rs1) * load_double(rs2) + load_double(rs3)));
+  res = host_fma_d(-load_double(rs1), load_double(rs2), -load_double(rs3));
   save_double(res, rd);
   dbg_printf("Result = %.3f\n\n", res);
 }
@@ -1348,16 +2877,24 @@ void ac_behavior(FNMADD_D) {
 // Instruction FCVT.W.D behavior method
 void ac_behavior(FCVT_W_D) {
   dbg_printf("FCVT.W.D r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %f\n", load_double(rs1));
-  RB[rd] = lround(load_double(rs1));
+  ac_word flags = 0;
+  RB[rd] = fcvt_int(load_double(rs1), -2147483648.0, 2147483647.0, flags);
+  if (flags)
+    fflags = fflags | flags;
   dbg_printf("RB[rd] = %d \n \n", RB[rd]);
 }
 
 // Instruction FCVT.WU.D behavior method
 void ac_behavior(FCVT_WU_D) {
   dbg_printf("FCVT.WU.D r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %f\n", load_double(rs1));
-  RB[rd] = (unsigned int)(load_double(rs1));
+  ac_word flags = 0;
+  RB[rd] = fcvt_int(load_double(rs1), 0.0, 4294967295.0, flags);
+  if (flags)
+    fflags = fflags | flags;
   dbg_printf("RB[rd] = %d \n \n", RB[rd]);
 }
 
@@ -1384,6 +2921,7 @@ void ac_behavior(FCVT_D_WU) {
 // Instruction FCVT_S_D behavior method
 void ac_behavior(FCVT_S_D) {
   dbg_printf("FCVT.S.D r%d, r%d", rd, rs1);
+  fp_round(funct3);
   dbg_printf("RBF[rs1] = %f \n", load_float(rs1));
   float temp;
   temp = (float)(load_double(rs1));
@@ -1412,11 +2950,8 @@ void ac_behavior(FEQ_D) {
   dbg_printf("FEQ.D r%d, r%d, r%d \n", rd, rs1, rs2);
   dbg_printf("RBF[rs1] = %f \n", load_double(rs1));
   dbg_printf("RBF[rs2] = %f \n", load_double(rs2));
-  if ((custom_isnan(load_double(rs1)) == 1) ||
-      (custom_isnan(load_double(rs2)) == 1)) {
-    printf("Invalid Operation\n");
-    RB[rd] = 0;
-  }
+  if (is_snan(load_double(rs1)) || is_snan(load_double(rs2)))
+    fflags = fflags | 0x10;
   if (load_double(rs1) == load_double(rs2))
     RB[rd] = 1;
   else
@@ -1429,11 +2964,8 @@ void ac_behavior(FLE_D) {
   dbg_printf("FLE.D r%d, r%d, r%d \n", rd, rs1, rs2);
   dbg_printf("RBF[rs1] = %f \n", load_double(rs1));
   dbg_printf("RBF[rs2] = %f \n", load_double(rs2));
-  if ((custom_isnan(load_double(rs1)) == 1) ||
-      (custom_isnan(load_double(rs2)) == 1)) {
-    printf("Invalid Operation\n");
-    RB[rd] = 0;
-  }
+  if (custom_isnan(load_double(rs1)) || custom_isnan(load_double(rs2)))
+    fflags = fflags | 0x10;
   if (load_double(rs1) <= load_double(rs2))
     RB[rd] = 1;
   else
@@ -1446,11 +2978,8 @@ void ac_behavior(FLT_D) {
   dbg_printf("FLT.D r%d, r%d, r%d \n", rd, rs1, rs2);
   dbg_printf("RBF[rs1] = %f \n", load_double(rs1));
   dbg_printf("RBF[rs2] = %f \n", load_double(rs2));
-  if ((custom_isnan(load_double(rs1)) == 1) ||
-      (custom_isnan(load_double(rs2)) == 1)) {
-    printf("Invalid Operation\n");
-    RB[rd] = 0;
-  }
+  if (custom_isnan(load_double(rs1)) || custom_isnan(load_double(rs2)))
+    fflags = fflags | 0x10;
   if (load_double(rs1) < load_double(rs2))
     RB[rd] = 1;
   else
@@ -1459,77 +2988,928 @@ void ac_behavior(FLT_D) {
 }
 
 
-// Instruction VSETVLI behavior method
-void ac_behavior(VSETVLI) {
+// Zfh behaviors. Halves are widened with host_h2f, computed in float and
+// narrowed with host_f2h in the instruction rounding mode.
 
-  vtype = (imm2 & 0x1f);
+// Instruction FLH behavior method
+void ac_behavior(FLH) {
+  int offset;
+  offset = (imm4 << 11) | (imm3 << 5) | (imm2 << 1) | imm1;
+  dbg_printf("FLH r%d, r%d, %d\n", rd, rs1, offset);
+  int sign_ext;
+  sign_ext = sign_extend(offset, 12);
+  save_half(DM.read_half(RB[rs1] + sign_ext), rd);
+  dbg_printf("addr = %#x\n", RB[rs1] + sign_ext);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
-  int sewf8 = 1 << ( vtype >> 3 );
-  int lmul = 1 << ( vtype & 0x7 );
-  int vlmax = lmul * ( vlenb & 0xff ) / sewf8;
-  int avl = RB[rs1];
+// Instruction FSH behavior method
+void ac_behavior(FSH) {
+  int imm;
+  imm = (imm4 << 11) | (imm3 << 5) | (imm2 << 1) | imm1;
+  dbg_printf("FSH r%d, r%d, %d\n", rs1, rs2, imm);
+  int sign_ext;
+  sign_ext = sign_extend(imm, 12);
+  store_check(RB[rs1] + sign_ext, 2);
+  DM.write_half(RB[rs1] + sign_ext, RBF[rs2].w[0] & 0xFFFF);
+  dbg_printf("addr: %d\n\n", RB[rs1] + sign_ext);
+}
 
-  vl = ( avl < vlmax ) ? avl : vlmax;
-  RB[rd] = vl;
+// Instruction FADD.H behavior method
+void ac_behavior(FADD_H) {
+  dbg_printf("FADD.H r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
+  float sum;
+  sum = host_h2f(load_half(rs1)) + host_h2f(load_half(rs2));
+  save_half(host_f2h(sum), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
-  dbg_printf("VSETVLI r%d, r%d, e%d, m%d\n", rd, rs1, 8 * sewf8, lmul );
-  dbg_printf("VL = %d\n\n", RB[rd] );
+// Instruction FSUB.H behavior method
+void ac_behavior(FSUB_H) {
+  dbg_printf("FSUB.H r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
+  float diff;
+  diff = host_h2f(load_half(rs1)) - host_h2f(load_half(rs2));
+  save_half(host_f2h(diff), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
+// Instruction FMUL.H behavior method
+void ac_behavior(FMUL_H) {
+  dbg_printf("FMUL.H r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
+  float product;
+  product = host_h2f(load_half(rs1)) * host_h2f(load_half(rs2));
+  save_half(host_f2h(product), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
 }
 
+// Instruction FDIV.H behavior method
+void ac_behavior(FDIV_H) {
+  dbg_printf("FDIV.H r%d, r%d, r%d\n", rd, rs1, rs2);
+  fp_round(funct3);
+  float quot;
+  quot = host_h2f(load_half(rs1)) / host_h2f(load_half(rs2));
+  save_half(host_f2h(quot), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
-// Instruction VLE behavior method
-void ac_behavior(VLE) {
+// Instruction FMIN.H behavior method
+void ac_behavior(FMIN_H) {
+  dbg_printf("FMIN.H r%d, r%d, r%d\n", rd, rs1, rs2);
+  if (host_h2f(load_half(rs1)) < host_h2f(load_half(rs2)))
+    save_half(load_half(rs1), rd);
+  else
+    save_half(load_half(rs2), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
-  int eew;
-  int addr = RB[rs1];
-  v128 *v = ( v128 * ) &RBV[ 4 * vd ];
+// Instruction FMAX.H behavior method
+void ac_behavior(FMAX_H) {
+  dbg_printf("FMAX.H r%d, r%d, r%d\n", rd, rs1, rs2);
+  if (host_h2f(load_half(rs1)) > host_h2f(load_half(rs2)))
+    save_half(load_half(rs1), rd);
+  else
+    save_half(load_half(rs2), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
+
+// Instruction FSQRT.H behavior method
+void ac_behavior(FSQRT_H) {
+  dbg_printf("FSQRT.H r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
+  save_half(host_f2h(sqrtf(host_h2f(load_half(rs1)))), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
+
+// Instruction FMADD.H behavior method
+void ac_behavior(FMADD_H) {
+  dbg_printf("FMADD.H r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
+  save_half(half_fma(host_h2f(load_half(rs1)), host_h2f(load_half(rs2)),
+                     host_h2f(load_half(rs3))), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
+
+// Instruction FMSUB.H behavior method
+void ac_behavior(FMSUB_H) {
+  dbg_printf("FMSUB.H r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
+  save_half(half_fma(host_h2f(load_half(rs1)), host_h2f(load_half(rs2)),
+                     -host_h2f(load_half(rs3))), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
+
+// Instruction FNMSUB.H behavior method
+void ac_behavior(FNMSUB_H) {
+  dbg_printf("FNMSUB.H r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
+  save_half(half_fma(-host_h2f(load_half(rs1)), host_h2f(load_half(rs2)),
+                     host_h2f(load_half(rs3))), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
+
+// Instruction FNMADD.H behavior method
+void ac_behavior(FNMADD_H) {
+  dbg_printf("FNMADD.H r%d, r%d, r%d, r%d\n", rd, rs1, rs2, rs3);
+  fp_round(funct3);
+  save_half(half_fma(-host_h2f(load_half(rs1)), host_h2f(load_half(rs2)),
+                     -host_h2f(load_half(rs3))), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
+
+// Instruction FCVT.S.H behavior method
+void ac_behavior(FCVT_S_H) {
+  dbg_printf("FCVT.S.H r%d, r%d\n", rd, rs1);
+  save_float(host_h2f(load_half(rs1)), rd);
+  dbg_printf("Result = %.3f\n\n", load_float(rd));
+}
+
+// Instruction FCVT.H.S behavior method
+void ac_behavior(FCVT_H_S) {
+  dbg_printf("FCVT.H.S r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
+  save_half(host_f2h(load_float(rs1)), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
+
+// Instruction FCVT.D.H behavior method
+void ac_behavior(FCVT_D_H) {
+  dbg_printf("FCVT.D.H r%d, r%d\n", rd, rs1);
+  save_double(host_h2f(load_half(rs1)), rd);
+  dbg_printf("Result = %.3f\n\n", load_double(rd));
+}
+
+// Instruction FCVT.H.D behavior method
+void ac_behavior(FCVT_H_D) {
+  dbg_printf("FCVT.H.D r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
+  save_half(half_from_double(load_double(rs1)), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
+
+// Instruction FCVT.W.H behavior method
+void ac_behavior(FCVT_W_H) {
+  dbg_printf("FCVT.W.H r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
+  ac_word flags = 0;
+  RB[rd] = fcvt_int(host_h2f(load_half(rs1)), -2147483648.0, 2147483647.0, flags);
+  if (flags)
+    fflags = fflags | flags;
+  dbg_printf("RB[rd] = %d \n \n", RB[rd]);
+}
 
-  if ( funct3 == 0 ) {
-    eew = 1;
-  } else if ( funct3 == 5 ) {
-    eew = 2;
-  } else if ( funct3 == 6 ) {
-    eew = 4;
-  }
+// Instruction FCVT.WU.H behavior method
+void ac_behavior(FCVT_WU_H) {
+  dbg_printf("FCVT.WU.H r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
+  ac_word flags = 0;
+  RB[rd] = fcvt_int(host_h2f(load_half(rs1)), 0.0, 4294967295.0, flags);
+  if (flags)
+    fflags = fflags | flags;
+  dbg_printf("RB[rd] = %d \n \n", RB[rd]);
+}
 
-  int vlmax = 128 / ( 8 * eew );
-  
-  dbg_printf("VLE%d.v v%d, (%d)\n", 8 * eew, vd, addr );
+// Instruction FCVT.H.W behavior method
+void ac_behavior(FCVT_H_W) {
+  dbg_printf("FCVT.H.W r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
+  ac_Sword b = RB[rs1];
+  save_half(half_from_double(b), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
-  for (int el = 0; el < vl; el++) {
+// Instruction FCVT.H.WU behavior method
+void ac_behavior(FCVT_H_WU) {
+  dbg_printf("FCVT.H.WU r%d, r%d\n", rd, rs1);
+  fp_round(funct3);
+  save_half(half_from_double(RB[rs1]), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
-    int idx = el % vlmax;
+// Instruction FSGNJ.H behavior method
+void ac_behavior(FSGNJ_H) {
+  dbg_printf("FSGNJ.H r%d, r%d, r%d\n", rd, rs1, rs2);
+  save_half((load_half(rs1) & 0x7FFF) | (load_half(rs2) & 0x8000), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
-    if ( eew == 1 ) {
-      v->set8( idx, DM.read_byte( addr + el * eew ) );
-    } else if ( eew == 2 ) {
-      v->set16( idx, DM.read_half( addr + el * eew ) );
-    } else if ( eew == 4 ) {
-      v->set32( idx, DM.read( addr + el * eew ) );
-    }
+// Instruction FSGNJN.H behavior method
+void ac_behavior(FSGNJN_H) {
+  dbg_printf("FSGNJN.H r%d, r%d, r%d\n", rd, rs1, rs2);
+  save_half((load_half(rs1) & 0x7FFF) | (~load_half(rs2) & 0x8000), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
-    if ( idx == vlmax-1 ) v++;
+// Instruction FSGNJX.H behavior method
+void ac_behavior(FSGNJX_H) {
+  dbg_printf("FSGNJX.H r%d, r%d, r%d\n", rd, rs1, rs2);
+  save_half(load_half(rs1) ^ (load_half(rs2) & 0x8000), rd);
+  dbg_printf("Result = %#x\n\n", load_half(rd));
+}
 
-  }
+// Instruction FMV.X.H behavior method
+void ac_behavior(FMV_X_H) {
+  dbg_printf("FMV.X.H r%d, r%d \n", rd, rs1);
+  RB[rd] = (int16_t)(RBF[rs1].w[0] & 0xFFFF);
+  dbg_printf("RB[rd] = %d \n \n", RB[rd]);
+}
 
-  v = ( v128 * ) &RBV[ 4 * vd ];
-  for( int c = 0; c < ( vl * eew ) / 4; c++ ) {
-    int i = c % 4;
-    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v->w[ i ]);
-    if ( i == 3 ) v++;
-  }
-  dbg_printf("bytes = %d\n\n", vl * eew);
+// Instruction FMV.H.X behavior method
+void ac_behavior(FMV_H_X) {
+  dbg_printf("FMV.H.X r%d, r%d \n", rd, rs1);
+  save_half(RB[rs1] & 0xFFFF, rd);
+  dbg_printf("RBF[rd] = %#x \n \n", load_half(rd));
+}
 
+// Instruction FEQ.H behavior method
+void ac_behavior(FEQ_H) {
+  dbg_printf("FEQ.H r%d, r%d, r%d \n", rd, rs1, rs2);
+  if (is_snan_half(load_half(rs1)) || is_snan_half(load_half(rs2)))
+    fflags = fflags | 0x10;
+  RB[rd] = host_h2f(load_half(rs1)) == host_h2f(load_half(rs2));
+  dbg_printf("Result = %d \n \n", RB[rd]);
 }
 
-// Instruction VLSE behavior method
-void ac_behavior(VLSE) {
+// Instruction FLT.H behavior method
+void ac_behavior(FLT_H) {
+  dbg_printf("FLT.H r%d, r%d, r%d \n", rd, rs1, rs2);
+  if (is_nan_half(load_half(rs1)) || is_nan_half(load_half(rs2)))
+    fflags = fflags | 0x10;
+  RB[rd] = host_h2f(load_half(rs1)) < host_h2f(load_half(rs2));
+  dbg_printf("Result = %d \n \n", RB[rd]);
+}
 
-  int eew;
-  int addr = RB[rs1];
-  int stride = RB[rs2];
-  v128 *v = ( v128 * ) &RBV[ 4 * vd ];
+// Instruction FLE.H behavior method
+void ac_behavior(FLE_H) {
+  dbg_printf("FLE.H r%d, r%d, r%d \n", rd, rs1, rs2);
+  if (is_nan_half(load_half(rs1)) || is_nan_half(load_half(rs2)))
+    fflags = fflags | 0x10;
+  RB[rd] = host_h2f(load_half(rs1)) <= host_h2f(load_half(rs2));
+  dbg_printf("Result = %d \n \n", RB[rd]);
+}
+
+// RV32C behaviors. Each one performs the 32-bit instruction it expands
+// to; ac_pc already points past the 16-bit instruction. Fields holding
+// 3-bit register numbers are offset by 8.
+
+// Instruction C.ADDI4SPN behavior method
+void ac_behavior(C_ADDI4SPN) {
+  int imm;
+  imm = ((imm1 >> 6) << 4) | (((imm1 >> 2) & 0xF) << 6) | (((imm1 >> 1) & 1) << 2) | ((imm1 & 1) << 3);
+  dbg_printf("C.ADDI4SPN r%d, %d\n", rd + 8, imm);
+  RB[rd + 8] = RB[2] + imm;
+  dbg_printf("Result = %#x\n\n", RB[rd + 8]);
+}
+
+// Instruction C.LW behavior method
+void ac_behavior(C_LW) {
+  int offset;
+  offset = (imm1 << 3) | ((imm2 >> 1) << 2) | ((imm2 & 1) << 6);
+  dbg_printf("C.LW r%d, r%d, %d\n", rd + 8, rs1 + 8, offset);
+  RB[rd + 8] = DM.read(RB[rs1 + 8] + offset);
+  dbg_printf("addr = %#x\n", RB[rs1 + 8] + offset);
+  dbg_printf("Result = %#x\n\n", RB[rd + 8]);
+}
+
+// Instruction C.FLW behavior method
+void ac_behavior(C_FLW) {
+  int offset;
+  offset = (imm1 << 3) | ((imm2 >> 1) << 2) | ((imm2 & 1) << 6);
+  dbg_printf("C.FLW r%d, r%d, %d\n", rd + 8, rs1 + 8, offset);
+  save_float_bits(DM.read(RB[rs1 + 8] + offset), rd + 8);
+  dbg_printf("addr = %#x\n", RB[rs1 + 8] + offset);
+  dbg_printf("Result = %.3f\n\n", load_float(rd + 8));
+}
+
+// Instruction C.FLD behavior method
+void ac_behavior(C_FLD) {
+  int offset;
+  offset = (imm1 << 3) | (imm2 << 6);
+  dbg_printf("C.FLD r%d, r%d, %d\n", rd + 8, rs1 + 8, offset);
+  RBF[rd + 8].w[0] = DM.read(RB[rs1 + 8] + offset);
+  RBF[rd + 8].w[1] = DM.read(RB[rs1 + 8] + offset + 4);
+  dbg_printf("addr = %#x\n", RB[rs1 + 8] + offset);
+  dbg_printf("Result = %lf\n\n", load_double(rd + 8));
+}
+
+// Instruction C.SW behavior method
+void ac_behavior(C_SW) {
+  int offset;
+  offset = (imm1 << 3) | ((imm2 >> 1) << 2) | ((imm2 & 1) << 6);
+  dbg_printf("C.SW r%d, r%d, %d\n", rs1 + 8, rs2 + 8, offset);
+  store_check(RB[rs1 + 8] + offset, 4);
+  DM.write(RB[rs1 + 8] + offset, RB[rs2 + 8]);
+  dbg_printf("addr: %#x\n\n", RB[rs1 + 8] + offset);
+}
+
+// Instruction C.FSW behavior method
+void ac_behavior(C_FSW) {
+  int offset;
+  offset = (imm1 << 3) | ((imm2 >> 1) << 2) | ((imm2 & 1) << 6);
+  dbg_printf("C.FSW r%d, r%d, %d\n", rs1 + 8, rs2 + 8, offset);
+  store_check(RB[rs1 + 8] + offset, 4);
+  DM.write(RB[rs1 + 8] + offset, RBF[rs2 + 8].w[0]);
+  dbg_printf("addr: %#x\n\n", RB[rs1 + 8] + offset);
+}
+
+// Instruction C.FSD behavior method
+void ac_behavior(C_FSD) {
+  int offset;
+  offset = (imm1 << 3) | (imm2 << 6);
+  dbg_printf("C.FSD r%d, r%d, %d\n", rs1 + 8, rs2 + 8, offset);
+  store_check(RB[rs1 + 8] + offset, 8);
+  DM.write(RB[rs1 + 8] + offset, RBF[rs2 + 8].w[0]);
+  DM.write(RB[rs1 + 8] + offset + 4, RBF[rs2 + 8].w[1]);
+  dbg_printf("addr: %#x\n\n", RB[rs1 + 8] + offset);
+}
+
+// Instruction C.ADDI behavior method (C.NOP when rd is x0)
+void ac_behavior(C_ADDI) {
+  int imm;
+  imm = sign_extend((imm1 << 5) | imm2, 6);
+  dbg_printf("C.ADDI r%d, %d\n", rd, imm);
+  if (rd != 0)
+    RB[rd] = RB[rd] + imm;
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction C.LI behavior method
+void ac_behavior(C_LI) {
+  int imm;
+  imm = sign_extend((imm1 << 5) | imm2, 6);
+  dbg_printf("C.LI r%d, %d\n", rd, imm);
+  RB[rd] = imm;
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction C.LUI behavior method, C.ADDI16SP when rd is x2
+void ac_behavior(C_LUI) {
+  int imm;
+  if (rd == 2) {
+    imm = (imm1 << 9) | (((imm2 >> 4) & 1) << 4) | (((imm2 >> 3) & 1) << 6) |
+          (((imm2 >> 1) & 3) << 7) | ((imm2 & 1) << 5);
+    imm = sign_extend(imm, 10);
+    dbg_printf("C.ADDI16SP %d\n", imm);
+    RB[2] = RB[2] + imm;
+  } else {
+    imm = sign_extend((imm1 << 5) | imm2, 6);
+    dbg_printf("C.LUI r%d, %d\n", rd, imm);
+    RB[rd] = imm << 12;
+  }
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction C.SLLI behavior method
+void ac_behavior(C_SLLI) {
+  dbg_printf("C.SLLI r%d, %d\n", rd, imm2);
+  RB[rd] = RB[rd] << imm2;
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction C.SRLI behavior method
+void ac_behavior(C_SRLI) {
+  dbg_printf("C.SRLI r%d, %d\n", rs1 + 8, imm2);
+  RB[rs1 + 8] = RB[rs1 + 8] >> imm2;
+  dbg_printf("Result = %#x\n\n", RB[rs1 + 8]);
+}
+
+// Instruction C.SRAI behavior method
+void ac_behavior(C_SRAI) {
+  dbg_printf("C.SRAI r%d, %d\n", rs1 + 8, imm2);
+  RB[rs1 + 8] = (ac_Sword)RB[rs1 + 8] >> imm2;
+  dbg_printf("Result = %#x\n\n", RB[rs1 + 8]);
+}
+
+// Instruction C.ANDI behavior method
+void ac_behavior(C_ANDI) {
+  int imm;
+  imm = sign_extend((imm1 << 5) | imm2, 6);
+  dbg_printf("C.ANDI r%d, %d\n", rs1 + 8, imm);
+  RB[rs1 + 8] = RB[rs1 + 8] & imm;
+  dbg_printf("Result = %#x\n\n", RB[rs1 + 8]);
+}
+
+// Instruction C.SUB behavior method
+void ac_behavior(C_SUB) {
+  dbg_printf("C.SUB r%d, r%d\n", rd + 8, rs2 + 8);
+  RB[rd + 8] = RB[rd + 8] - RB[rs2 + 8];
+  dbg_printf("Result = %#x\n\n", RB[rd + 8]);
+}
+
+// Instruction C.XOR behavior method
+void ac_behavior(C_XOR) {
+  dbg_printf("C.XOR r%d, r%d\n", rd + 8, rs2 + 8);
+  RB[rd + 8] = RB[rd + 8] ^ RB[rs2 + 8];
+  dbg_printf("Result = %#x\n\n", RB[rd + 8]);
+}
+
+// Instruction C.OR behavior method
+void ac_behavior(C_OR) {
+  dbg_printf("C.OR r%d, r%d\n", rd + 8, rs2 + 8);
+  RB[rd + 8] = RB[rd + 8] | RB[rs2 + 8];
+  dbg_printf("Result = %#x\n\n", RB[rd + 8]);
+}
+
+// Instruction C.AND behavior method
+void ac_behavior(C_AND) {
+  dbg_printf("C.AND r%d, r%d\n", rd + 8, rs2 + 8);
+  RB[rd + 8] = RB[rd + 8] & RB[rs2 + 8];
+  dbg_printf("Result = %#x\n\n", RB[rd + 8]);
+}
+
+// Offset of C.J and C.JAL, scattered over imm1 as [11|4|9:8|10|6|7|3:1|5]
+static inline int cj_offset(unsigned int imm1) {
+  int offset;
+  offset = (((imm1 >> 10) & 1) << 11) | (((imm1 >> 9) & 1) << 4) |
+           (((imm1 >> 7) & 3) << 8) | (((imm1 >> 6) & 1) << 10) |
+           (((imm1 >> 5) & 1) << 6) | (((imm1 >> 4) & 1) << 7) |
+           (((imm1 >> 1) & 7) << 1) | ((imm1 & 1) << 5);
+  return (offset << 20) >> 20;
+}
+
+// Offset of C.BEQZ and C.BNEZ: imm1 is [8|4:3], imm2 is [7:6|2:1|5]
+static inline int cb_offset(unsigned int imm1, unsigned int imm2) {
+  int offset;
+  offset = (((imm1 >> 2) & 1) << 8) | ((imm1 & 3) << 3) |
+           (((imm2 >> 3) & 3) << 6) | (((imm2 >> 1) & 3) << 1) | ((imm2 & 1) << 5);
+  return (offset << 23) >> 23;
+}
+
+// Instruction C.J behavior method
+void ac_behavior(C_J) {
+  int offset = cj_offset(imm1);
+  dbg_printf("C.J %d\n", offset);
+  ac_pc = ac_pc - 2 + offset;
+  dbg_printf("--- Jump taken ---\n\n");
+}
+
+// Instruction C.JAL behavior method
+void ac_behavior(C_JAL) {
+  int offset = cj_offset(imm1);
+  dbg_printf("C.JAL %d\n", offset);
+  RB[Ra] = ac_pc;
+  ac_pc = ac_pc - 2 + offset;
+  prof_call(ac_pc);
+  dbg_printf("--- Jump taken ---\n\n");
+}
+
+// Instruction C.BEQZ behavior method
+void ac_behavior(C_BEQZ) {
+  int offset = cb_offset(imm1, imm2);
+  dbg_printf("C.BEQZ r%d, %d\n", rs1 + 8, offset);
+  if (RB[rs1 + 8] == 0) {
+    ac_pc = ac_pc - 2 + offset;
+    hpm_event[HPM_TAKEN]++;
+    dbg_printf("---Branch Taken--- to %#x\n\n", (int)ac_pc);
+  } else
+    dbg_printf("---Branch not Taken---\n\n");
+}
+
+// Instruction C.BNEZ behavior method
+void ac_behavior(C_BNEZ) {
+  int offset = cb_offset(imm1, imm2);
+  dbg_printf("C.BNEZ r%d, %d\n", rs1 + 8, offset);
+  if (RB[rs1 + 8] != 0) {
+    ac_pc = ac_pc - 2 + offset;
+    hpm_event[HPM_TAKEN]++;
+    dbg_printf("---Branch Taken--- to %#x\n\n", (int)ac_pc);
+  } else
+    dbg_printf("---Branch not Taken---\n\n");
+}
+
+// Instruction C.LWSP behavior method
+void ac_behavior(C_LWSP) {
+  int offset;
+  offset = (imm1 << 5) | ((imm2 >> 2) << 2) | ((imm2 & 3) << 6);
+  dbg_printf("C.LWSP r%d, %d\n", rd, offset);
+  RB[rd] = DM.read(RB[2] + offset);
+  dbg_printf("addr = %#x\n", RB[2] + offset);
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction C.FLWSP behavior method
+void ac_behavior(C_FLWSP) {
+  int offset;
+  offset = (imm1 << 5) | ((imm2 >> 2) << 2) | ((imm2 & 3) << 6);
+  dbg_printf("C.FLWSP r%d, %d\n", rd, offset);
+  save_float_bits(DM.read(RB[2] + offset), rd);
+  dbg_printf("addr = %#x\n", RB[2] + offset);
+  dbg_printf("Result = %.3f\n\n", load_float(rd));
+}
+
+// Instruction C.FLDSP behavior method
+void ac_behavior(C_FLDSP) {
+  int offset;
+  offset = (imm1 << 5) | ((imm2 >> 3) << 3) | ((imm2 & 7) << 6);
+  dbg_printf("C.FLDSP r%d, %d\n", rd, offset);
+  RBF[rd].w[0] = DM.read(RB[2] + offset);
+  RBF[rd].w[1] = DM.read(RB[2] + offset + 4);
+  dbg_printf("addr = %#x\n", RB[2] + offset);
+  dbg_printf("Result = %lf\n\n", load_double(rd));
+}
+
+// Instruction C.SWSP behavior method
+void ac_behavior(C_SWSP) {
+  int offset;
+  offset = ((imm1 >> 2) << 2) | ((imm1 & 3) << 6);
+  dbg_printf("C.SWSP r%d, %d\n", rs2, offset);
+  store_check(RB[2] + offset, 4);
+  DM.write(RB[2] + offset, RB[rs2]);
+  dbg_printf("addr: %#x\n\n", RB[2] + offset);
+}
+
+// Instruction C.FSWSP behavior method
+void ac_behavior(C_FSWSP) {
+  int offset;
+  offset = ((imm1 >> 2) << 2) | ((imm1 & 3) << 6);
+  dbg_printf("C.FSWSP r%d, %d\n", rs2, offset);
+  store_check(RB[2] + offset, 4);
+  DM.write(RB[2] + offset, RBF[rs2].w[0]);
+  dbg_printf("addr: %#x\n\n", RB[2] + offset);
+}
+
+// Instruction C.FSDSP behavior method
+void ac_behavior(C_FSDSP) {
+  int offset;
+  offset = ((imm1 >> 3) << 3) | ((imm1 & 7) << 6);
+  dbg_printf("C.FSDSP r%d, %d\n", rs2, offset);
+  store_check(RB[2] + offset, 8);
+  DM.write(RB[2] + offset, RBF[rs2].w[0]);
+  DM.write(RB[2] + offset + 4, RBF[rs2].w[1]);
+  dbg_printf("addr: %#x\n\n", RB[2] + offset);
+}
+
+// Instruction C.MV behavior method, C.JR when rs2 is x0
+void ac_behavior(C_MV) {
+  if (rs2 == 0) {
+    dbg_printf("C.JR r%d\n", rd);
+    ac_pc = RB[rd] & ~1;
+    if (rd == Ra)
+      prof_return();
+    dbg_printf("--- Jump taken ---\n\n");
+  } else {
+    dbg_printf("C.MV r%d, r%d\n", rd, rs2);
+    RB[rd] = RB[rs2];
+    dbg_printf("Result = %#x\n\n", RB[rd]);
+  }
+}
+
+// Instruction C.ADD behavior method, C.JALR or C.EBREAK when rs2 is x0
+void ac_behavior(C_ADD) {
+  if (rs2 == 0 && rd == 0) {
+    dbg_printf("C.EBREAK\n");
+    printf("Breakpoint\n\n");
+    stop();
+  } else if (rs2 == 0) {
+    dbg_printf("C.JALR r%d\n", rd);
+    ac_word target = RB[rd] & ~1;
+    RB[Ra] = ac_pc;
+    ac_pc = target;
+    prof_call(target);
+    dbg_printf("--- Jump taken ---\n\n");
+  } else {
+    dbg_printf("C.ADD r%d, r%d\n", rd, rs2);
+    RB[rd] = RB[rd] + RB[rs2];
+    dbg_printf("Result = %#x\n\n", RB[rd]);
+  }
+}
+
+// Zba/Zbb/Zbs behaviors. The builtins and rotate idioms below each
+// compile to one host instruction (lea, bsr/bsf, ror, bswap, bt*).
+
+// Instruction SH1ADD behavior method
+void ac_behavior(SH1ADD) {
+  dbg_printf("SH1ADD r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = RB[rs2] + (RB[rs1] << 1);
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction SH2ADD behavior method
+void ac_behavior(SH2ADD) {
+  dbg_printf("SH2ADD r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = RB[rs2] + (RB[rs1] << 2);
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction SH3ADD behavior method
+void ac_behavior(SH3ADD) {
+  dbg_printf("SH3ADD r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = RB[rs2] + (RB[rs1] << 3);
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction ANDN behavior method
+void ac_behavior(ANDN) {
+  dbg_printf("ANDN r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = RB[rs1] & ~RB[rs2];
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction ORN behavior method
+void ac_behavior(ORN) {
+  dbg_printf("ORN r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = RB[rs1] | ~RB[rs2];
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction XNOR behavior method
+void ac_behavior(XNOR) {
+  dbg_printf("XNOR r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = ~(RB[rs1] ^ RB[rs2]);
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction MIN behavior method
+void ac_behavior(MIN) {
+  dbg_printf("MIN r%d, r%d, r%d\n", rd, rs1, rs2);
+  ac_Sword a = RB[rs1], b = RB[rs2];
+  RB[rd] = (a < b) ? a : b;
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction MINU behavior method
+void ac_behavior(MINU) {
+  dbg_printf("MINU r%d, r%d, r%d\n", rd, rs1, rs2);
+  ac_word a = RB[rs1], b = RB[rs2];
+  RB[rd] = (a < b) ? a : b;
+  dbg_printf("Result = %u\n\n", RB[rd]);
+}
+
+// Instruction MAX behavior method
+void ac_behavior(MAX) {
+  dbg_printf("MAX r%d, r%d, r%d\n", rd, rs1, rs2);
+  ac_Sword a = RB[rs1], b = RB[rs2];
+  RB[rd] = (a > b) ? a : b;
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction MAXU behavior method
+void ac_behavior(MAXU) {
+  dbg_printf("MAXU r%d, r%d, r%d\n", rd, rs1, rs2);
+  ac_word a = RB[rs1], b = RB[rs2];
+  RB[rd] = (a > b) ? a : b;
+  dbg_printf("Result = %u\n\n", RB[rd]);
+}
+
+// Instruction ROL behavior method
+void ac_behavior(ROL) {
+  dbg_printf("ROL r%d, r%d, r%d\n", rd, rs1, rs2);
+  ac_word x = RB[rs1];
+  int shamt = RB[rs2] & 0x1F;
+  RB[rd] = (x << shamt) | (x >> ((32 - shamt) & 0x1F));
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction ROR behavior method
+void ac_behavior(ROR) {
+  dbg_printf("ROR r%d, r%d, r%d\n", rd, rs1, rs2);
+  ac_word x = RB[rs1];
+  int shamt = RB[rs2] & 0x1F;
+  RB[rd] = (x >> shamt) | (x << ((32 - shamt) & 0x1F));
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction RORI behavior method
+void ac_behavior(RORI) {
+  short int shamt;
+  shamt = (imm2 << 1) | imm1;
+  dbg_printf("RORI r%d, r%d, %d\n", rd, rs1, shamt);
+  ac_word x = RB[rs1];
+  RB[rd] = (x >> shamt) | (x << ((32 - shamt) & 0x1F));
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction ZEXT.H behavior method
+void ac_behavior(ZEXT_H) {
+  dbg_printf("ZEXT.H r%d, r%d\n", rd, rs1);
+  RB[rd] = RB[rs1] & 0xFFFF;
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction CLZ behavior method
+void ac_behavior(CLZ) {
+  dbg_printf("CLZ r%d, r%d\n", rd, rs1);
+  ac_word x = RB[rs1];
+  RB[rd] = x ? __builtin_clz(x) : 32;
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction CTZ behavior method
+void ac_behavior(CTZ) {
+  dbg_printf("CTZ r%d, r%d\n", rd, rs1);
+  ac_word x = RB[rs1];
+  RB[rd] = x ? __builtin_ctz(x) : 32;
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction CPOP behavior method
+void ac_behavior(CPOP) {
+  dbg_printf("CPOP r%d, r%d\n", rd, rs1);
+  RB[rd] = host_popcount(RB[rs1]);
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction SEXT.B behavior method
+void ac_behavior(SEXT_B) {
+  dbg_printf("SEXT.B r%d, r%d\n", rd, rs1);
+  RB[rd] = (int8_t)RB[rs1];
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction SEXT.H behavior method
+void ac_behavior(SEXT_H) {
+  dbg_printf("SEXT.H r%d, r%d\n", rd, rs1);
+  RB[rd] = (int16_t)RB[rs1];
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction REV8 behavior method
+void ac_behavior(REV8) {
+  dbg_printf("REV8 r%d, r%d\n", rd, rs1);
+  RB[rd] = __builtin_bswap32(RB[rs1]);
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction ORC.B behavior method
+void ac_behavior(ORC_B) {
+  dbg_printf("ORC.B r%d, r%d\n", rd, rs1);
+  ac_word x = RB[rs1];
+  // Top bit of each byte set when the byte is non-zero, then widened
+  ac_word nz = (((x & 0x7F7F7F7F) + 0x7F7F7F7F) | x) & 0x80808080;
+  RB[rd] = (nz >> 7) * 0xFF;
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction BCLR behavior method
+void ac_behavior(BCLR) {
+  dbg_printf("BCLR r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = RB[rs1] & ~(1u << (RB[rs2] & 0x1F));
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction BEXT behavior method
+void ac_behavior(BEXT) {
+  dbg_printf("BEXT r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = (RB[rs1] >> (RB[rs2] & 0x1F)) & 1;
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction BINV behavior method
+void ac_behavior(BINV) {
+  dbg_printf("BINV r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = RB[rs1] ^ (1u << (RB[rs2] & 0x1F));
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction BSET behavior method
+void ac_behavior(BSET) {
+  dbg_printf("BSET r%d, r%d, r%d\n", rd, rs1, rs2);
+  RB[rd] = RB[rs1] | (1u << (RB[rs2] & 0x1F));
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction BCLRI behavior method
+void ac_behavior(BCLRI) {
+  short int shamt;
+  shamt = (imm2 << 1) | imm1;
+  dbg_printf("BCLRI r%d, r%d, %d\n", rd, rs1, shamt);
+  RB[rd] = RB[rs1] & ~(1u << shamt);
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction BEXTI behavior method
+void ac_behavior(BEXTI) {
+  short int shamt;
+  shamt = (imm2 << 1) | imm1;
+  dbg_printf("BEXTI r%d, r%d, %d\n", rd, rs1, shamt);
+  RB[rd] = (RB[rs1] >> shamt) & 1;
+  dbg_printf("Result = %d\n\n", RB[rd]);
+}
+
+// Instruction BINVI behavior method
+void ac_behavior(BINVI) {
+  short int shamt;
+  shamt = (imm2 << 1) | imm1;
+  dbg_printf("BINVI r%d, r%d, %d\n", rd, rs1, shamt);
+  RB[rd] = RB[rs1] ^ (1u << shamt);
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction BSETI behavior method
+void ac_behavior(BSETI) {
+  short int shamt;
+  shamt = (imm2 << 1) | imm1;
+  dbg_printf("BSETI r%d, r%d, %d\n", rd, rs1, shamt);
+  RB[rd] = RB[rs1] | (1u << shamt);
+  dbg_printf("Result = %#x\n\n", RB[rd]);
+}
+
+// Instruction VSETVLI behavior method
+void ac_behavior(VSETVLI) {
+
+  int vlmax = vset_vtype( imm2 );
+  ac_word avl = RB[rs1];
+
+  if ( rs1 == 0 )
+    avl = ( rd == 0 ) ? ( ac_word ) vl : ~0u;
+
+  vl = ( avl < vlmax ) ? avl : vlmax;
+  RB[rd] = vl;
+
+  dbg_printf("VSETVLI r%d, r%d, e%d, lmul %d/8%s\n", rd, rs1, 8 * vcfg.sew, vcfg.lmul8, vcfg.vill ? ", vill" : "" );
+  dbg_printf("VL = %d\n\n", RB[rd] );
+
+}
+
+// Instruction VSETIVLI behavior method
+void ac_behavior(VSETIVLI) {
+
+  int vlmax = vset_vtype( imm4 );
+  ac_word avl = rs1;
+
+  vl = ( avl < vlmax ) ? avl : vlmax;
+  RB[rd] = vl;
+
+  dbg_printf("VSETIVLI r%d, %d, e%d, lmul %d/8%s\n", rd, rs1, 8 * vcfg.sew, vcfg.lmul8, vcfg.vill ? ", vill" : "" );
+  dbg_printf("VL = %d\n\n", RB[rd] );
+
+}
+
+// Instruction VSETVL behavior method
+void ac_behavior(VSETVL) {
+
+  int vlmax = vset_vtype( RB[rs2] );
+  ac_word avl = RB[rs1];
+
+  if ( rs1 == 0 )
+    avl = ( rd == 0 ) ? ( ac_word ) vl : ~0u;
+
+  vl = ( avl < vlmax ) ? avl : vlmax;
+  RB[rd] = vl;
+
+  dbg_printf("VSETVL r%d, r%d, r%d, e%d, lmul %d/8%s\n", rd, rs1, rs2, 8 * vcfg.sew, vcfg.lmul8, vcfg.vill ? ", vill" : "" );
+  dbg_printf("VL = %d\n\n", RB[rd] );
+
+}
+
+
+// Instruction VLE behavior method
+void ac_behavior(VLE) {
+
+  int eew;
+  int addr = RB[rs1];
+  v128 *v = ( v128 * ) &RBV[ 4 * vd ];
+
+  if ( funct3 == 0 ) {
+    eew = 1;
+  } else if ( funct3 == 5 ) {
+    eew = 2;
+  } else if ( funct3 == 6 ) {
+    eew = 4;
+  }
+
+  int vlmax = 128 / ( 8 * eew );
+  
+  dbg_printf("VLE%d.v v%d, (%d)\n", 8 * eew, vd, addr );
+
+  for (int el = 0; el < vl; el++) {
+
+    int idx = el % vlmax;
+
+    if ( eew == 1 ) {
+      v->set8( idx, DM.read_byte( addr + el * eew ) );
+    } else if ( eew == 2 ) {
+      v->set16( idx, DM.read_half( addr + el * eew ) );
+    } else if ( eew == 4 ) {
+      v->set32( idx, DM.read( addr + el * eew ) );
+    }
+
+    if ( idx == vlmax-1 ) v++;
+
+  }
+
+  vtail_fill( vd, vl * eew );
+
+  v = ( v128 * ) &RBV[ 4 * vd ];
+  for( int c = 0; c < ( vl * eew ) / 4; c++ ) {
+    int i = c % 4;
+    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v->w[ i ]);
+    if ( i == 3 ) v++;
+  }
+  hpm_event[ HPM_VLOAD_BYTES ] += vl * eew;
+  dbg_printf("bytes = %d\n\n", vl * eew);
+
+}
+
+// Instruction VLSE behavior method
+void ac_behavior(VLSE) {
+
+  int eew;
+  int addr = RB[rs1];
+  int stride = RB[rs2];
+  v128 *v = ( v128 * ) &RBV[ 4 * vd ];
 
   if ( funct3 == 0 ) {
     eew = 1;
@@ -1559,12 +3939,15 @@ void ac_behavior(VLSE) {
 
   }
 
+  vtail_fill( vd, vl * eew );
+
   v = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * eew ) / 4; c++ ) {
     int i = c % 4;
     dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v->w[ i ]);
     if ( i == 3 ) v++;
   }
+  hpm_event[ HPM_VLOAD_BYTES ] += vl * eew;
   dbg_printf("bytes = %d\n\n", vl * eew);
 
 }
@@ -1588,6 +3971,8 @@ void ac_behavior(VSE) {
   
   dbg_printf("VSE%d.v v%d, (%d)\n", 8 * eew, vd, addr );
 
+  store_check( addr, vl * eew );
+
   for (int el = 0; el < vl; el++) {
 
     int idx = el % vlmax;
@@ -1609,6 +3994,7 @@ void ac_behavior(VSE) {
     dbg_printf("M[%d] = %d\n", addr + c * 4, DM.read( addr + c * 4 ) );
     if ( i == 3 ) v++;
   }
+  hpm_event[ HPM_VSTORE_BYTES ] += vl * eew;
   dbg_printf("bytes = %d\n\n", vl * eew);
 
 }
@@ -1637,6 +4023,8 @@ void ac_behavior(VSSE) {
 
     int idx = el % vlmax;
 
+    store_check( addr + el * stride, eew );
+
     if ( eew == 1 ) {
       DM.write_byte( addr + el * stride, v->get8( idx ) );
     } else if ( eew == 2 ) {
@@ -1654,14 +4042,49 @@ void ac_behavior(VSSE) {
     dbg_printf("M[%d] = %d\n", addr + c * 4, DM.read( addr + c * 4 ) );
     if ( i == 3 ) v++;
   }
+  hpm_event[ HPM_VSTORE_BYTES ] += vl * eew;
   dbg_printf("bytes = %d\n\n", vl * eew);
 
 }
 
+// Instruction VLRE behavior method
+void ac_behavior(VLRE) {
+
+  int nr = nf + 1;
+  int addr = RB[rs1];
+
+  dbg_printf("VL%dRE.v v%d, (%d)\n", nr, vd, addr );
+
+  for ( int w = 0; w < 4 * nr; w++ )
+    RBV[ 4 * vd + w ] = DM.read( addr + 4 * w );
+
+  hpm_event[ HPM_VLOAD_BYTES ] += 16 * nr;
+  dbg_printf("bytes = %d\n\n", 16 * nr);
+
+}
+
+// Instruction VSR behavior method
+void ac_behavior(VSR) {
+
+  int nr = nf + 1;
+  int addr = RB[rs1];
+
+  dbg_printf("VS%dR.v v%d, (%d)\n", nr, vd, addr );
+
+  store_check( addr, 16 * nr );
+
+  for ( int w = 0; w < 4 * nr; w++ )
+    DM.write( addr + 4 * w, RBV[ 4 * vd + w ] );
+
+  hpm_event[ HPM_VSTORE_BYTES ] += 16 * nr;
+  dbg_printf("bytes = %d\n\n", 16 * nr);
+
+}
+
 // Instruction VADDVV behavior method
 void ac_behavior(VADDVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -1688,6 +4111,8 @@ void ac_behavior(VADDVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -1701,7 +4126,7 @@ void ac_behavior(VADDVV) {
 // Instruction VSUBVV behavior method
 void ac_behavior(VSUBVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -1728,6 +4153,8 @@ void ac_behavior(VSUBVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -1738,10 +4165,128 @@ void ac_behavior(VSUBVV) {
 
 }
 
+// Instruction VADCVVM behavior method
+void ac_behavior(VADCVVM) {
+
+  dbg_printf("VADC.VVM v%d, v%d, v%d, v0\n", vd, rs2, rs1 );
+
+  vexec_vvm< vu8x16, vu16x8, vu32x4 >( vadc_op(), vd, rs2, rs1, true );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VADCVXM behavior method
+void ac_behavior(VADCVXM) {
+
+  dbg_printf("VADC.VXM v%d, v%d, r%d, v0\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vxm< vu8x16, vu16x8, vu32x4 >( vadc_op(), vd, rs2, RB[rs1], true );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VADCVIM behavior method
+void ac_behavior(VADCVIM) {
+
+  int imm = sign_extend( rs1, 5 );
+
+  dbg_printf("VADC.VIM v%d, v%d, %d, v0\n", vd, rs2, imm );
+
+  vexec_vxm< vu8x16, vu16x8, vu32x4 >( vadc_op(), vd, rs2, imm, true );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMADCVV behavior method
+void ac_behavior(VMADCVV) {
+
+  dbg_printf("VMADC.VV v%d, v%d, v%d%s\n", vd, rs2, rs1, vm ? "" : ", v0" );
+
+  vexec_vvm< vu8x16, vu16x8, vu32x4 >( vmadc_op(), vd, rs2, rs1, !vm );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMADCVX behavior method
+void ac_behavior(VMADCVX) {
+
+  dbg_printf("VMADC.VX v%d, v%d, r%d%s\n", vd, rs2, rs1, vm ? "" : ", v0" );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vxm< vu8x16, vu16x8, vu32x4 >( vmadc_op(), vd, rs2, RB[rs1], !vm );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMADCVI behavior method
+void ac_behavior(VMADCVI) {
+
+  int imm = sign_extend( rs1, 5 );
+
+  dbg_printf("VMADC.VI v%d, v%d, %d%s\n", vd, rs2, imm, vm ? "" : ", v0" );
+
+  vexec_vxm< vu8x16, vu16x8, vu32x4 >( vmadc_op(), vd, rs2, imm, !vm );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VSBCVVM behavior method
+void ac_behavior(VSBCVVM) {
+
+  dbg_printf("VSBC.VVM v%d, v%d, v%d, v0\n", vd, rs2, rs1 );
+
+  vexec_vvm< vu8x16, vu16x8, vu32x4 >( vsbc_op(), vd, rs2, rs1, true );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VSBCVXM behavior method
+void ac_behavior(VSBCVXM) {
+
+  dbg_printf("VSBC.VXM v%d, v%d, r%d, v0\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vxm< vu8x16, vu16x8, vu32x4 >( vsbc_op(), vd, rs2, RB[rs1], true );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSBCVV behavior method
+void ac_behavior(VMSBCVV) {
+
+  dbg_printf("VMSBC.VV v%d, v%d, v%d%s\n", vd, rs2, rs1, vm ? "" : ", v0" );
+
+  vexec_vvm< vu8x16, vu16x8, vu32x4 >( vmsbc_op(), vd, rs2, rs1, !vm );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSBCVX behavior method
+void ac_behavior(VMSBCVX) {
+
+  dbg_printf("VMSBC.VX v%d, v%d, r%d%s\n", vd, rs2, rs1, vm ? "" : ", v0" );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vxm< vu8x16, vu16x8, vu32x4 >( vmsbc_op(), vd, rs2, RB[rs1], !vm );
+
+  dbg_vreg( vd );
+
+}
+
 // Instruction VMULVV behavior method
 void ac_behavior(VMULVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -1768,6 +4313,8 @@ void ac_behavior(VMULVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -1778,10 +4325,118 @@ void ac_behavior(VMULVV) {
 
 }
 
+// Instruction VDIVUVV behavior method
+void ac_behavior(VDIVUVV) {
+
+  fp_flags_guard guard;
+
+  dbg_printf("VDIVU.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vu8x16, vu16x8, vu32x4 >( vdiv_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VDIVUVX behavior method
+void ac_behavior(VDIVUVX) {
+
+  fp_flags_guard guard;
+
+  dbg_printf("VDIVU.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vu8x16, vu16x8, vu32x4 >( vdiv_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VDIVVV behavior method
+void ac_behavior(VDIVVV) {
+
+  fp_flags_guard guard;
+
+  dbg_printf("VDIV.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vs8x16, vs16x8, vs32x4 >( vdiv_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VDIVVX behavior method
+void ac_behavior(VDIVVX) {
+
+  fp_flags_guard guard;
+
+  dbg_printf("VDIV.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vs8x16, vs16x8, vs32x4 >( vdiv_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VREMUVV behavior method
+void ac_behavior(VREMUVV) {
+
+  fp_flags_guard guard;
+
+  dbg_printf("VREMU.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vu8x16, vu16x8, vu32x4 >( vrem_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VREMUVX behavior method
+void ac_behavior(VREMUVX) {
+
+  fp_flags_guard guard;
+
+  dbg_printf("VREMU.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vu8x16, vu16x8, vu32x4 >( vrem_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VREMVV behavior method
+void ac_behavior(VREMVV) {
+
+  fp_flags_guard guard;
+
+  dbg_printf("VREM.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vs8x16, vs16x8, vs32x4 >( vrem_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VREMVX behavior method
+void ac_behavior(VREMVX) {
+
+  fp_flags_guard guard;
+
+  dbg_printf("VREM.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vs8x16, vs16x8, vs32x4 >( vrem_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
 // Instruction VADDVX behavior method
 void ac_behavior(VADDVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -1808,6 +4463,8 @@ void ac_behavior(VADDVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -1821,7 +4478,7 @@ void ac_behavior(VADDVX) {
 // Instruction VSUBVX behavior method
 void ac_behavior(VSUBVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -1848,6 +4505,8 @@ void ac_behavior(VSUBVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -1861,7 +4520,7 @@ void ac_behavior(VSUBVX) {
 // Instruction VADDVI behavior method
 void ac_behavior(VADDVI) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
 
@@ -1888,6 +4547,8 @@ void ac_behavior(VADDVI) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -1901,7 +4562,7 @@ void ac_behavior(VADDVI) {
 // Instruction VANDVV behavior method
 void ac_behavior(VANDVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -1928,6 +4589,8 @@ void ac_behavior(VANDVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -1941,7 +4604,7 @@ void ac_behavior(VANDVV) {
 // Instruction VANDVX behavior method
 void ac_behavior(VANDVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -1968,6 +4631,8 @@ void ac_behavior(VANDVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -1981,7 +4646,7 @@ void ac_behavior(VANDVX) {
 // Instruction VANDVI behavior method
 void ac_behavior(VANDVI) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2008,6 +4673,8 @@ void ac_behavior(VANDVI) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2021,7 +4688,7 @@ void ac_behavior(VANDVI) {
 // Instruction VORVV behavior method
 void ac_behavior(VORVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -2048,6 +4715,8 @@ void ac_behavior(VORVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2061,7 +4730,7 @@ void ac_behavior(VORVV) {
 // Instruction VORVX behavior method
 void ac_behavior(VORVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2088,6 +4757,8 @@ void ac_behavior(VORVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2101,7 +4772,7 @@ void ac_behavior(VORVX) {
 // Instruction VORVI behavior method
 void ac_behavior(VORVI) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2128,6 +4799,8 @@ void ac_behavior(VORVI) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2141,7 +4814,7 @@ void ac_behavior(VORVI) {
 // Instruction VXORVV behavior method
 void ac_behavior(VXORVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -2168,6 +4841,8 @@ void ac_behavior(VXORVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2181,7 +4856,7 @@ void ac_behavior(VXORVV) {
 // Instruction VXORVX behavior method
 void ac_behavior(VXORVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2208,6 +4883,8 @@ void ac_behavior(VXORVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2221,7 +4898,7 @@ void ac_behavior(VXORVX) {
 // Instruction VXORVI behavior method
 void ac_behavior(VXORVI) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2248,6 +4925,8 @@ void ac_behavior(VXORVI) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2261,7 +4940,7 @@ void ac_behavior(VXORVI) {
 // Instruction VMINUVV behavior method
 void ac_behavior(VMINUVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -2297,6 +4976,8 @@ void ac_behavior(VMINUVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2310,7 +4991,7 @@ void ac_behavior(VMINUVV) {
 // Instruction VMINUVX behavior method
 void ac_behavior(VMINUVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2346,6 +5027,8 @@ void ac_behavior(VMINUVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2359,7 +5042,7 @@ void ac_behavior(VMINUVX) {
 // Instruction VMAXUVV behavior method
 void ac_behavior(VMAXUVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -2395,6 +5078,8 @@ void ac_behavior(VMAXUVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2408,7 +5093,7 @@ void ac_behavior(VMAXUVV) {
 // Instruction VMAXUVX behavior method
 void ac_behavior(VMAXUVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2438,19 +5123,67 @@ void ac_behavior(VMAXUVX) {
         v0->set32( idx, v1->get32( idx ) );
     }
 
-    if ( idx == vlmax-1 ) {
-      v0++; v1++;
-    }
+    if ( idx == vlmax-1 ) {
+      v0++; v1++;
+    }
+
+  }
+
+  vtail_fill( vd, vl * sew );
+
+  v0 = ( v128 * ) &RBV[ 4 * vd ];
+  for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
+    int i = c % 4;
+    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v0->w[ i ]);
+    if ( i == 3 ) v0++;
+  }
+  dbg_printf("bytes = %d\n\n", vl * sew);
+
+}
+
+// Instruction VMINVV behavior method
+void ac_behavior(VMINVV) {
+
+  dbg_printf("VMIN.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vs8x16, vs16x8, vs32x4 >( vmin_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMINVX behavior method
+void ac_behavior(VMINVX) {
+
+  dbg_printf("VMIN.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vs8x16, vs16x8, vs32x4 >( vmin_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMAXVV behavior method
+void ac_behavior(VMAXVV) {
+
+  dbg_printf("VMAX.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vs8x16, vs16x8, vs32x4 >( vmax_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
 
-  }
+// Instruction VMAXVX behavior method
+void ac_behavior(VMAXVX) {
 
-  v0 = ( v128 * ) &RBV[ 4 * vd ];
-  for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
-    int i = c % 4;
-    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v0->w[ i ]);
-    if ( i == 3 ) v0++;
-  }
-  dbg_printf("bytes = %d\n\n", vl * sew);
+  dbg_printf("VMAX.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vs8x16, vs16x8, vs32x4 >( vmax_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
 
 }
 
@@ -2458,7 +5191,7 @@ void ac_behavior(VMAXUVX) {
 void ac_behavior(VMVXS) {
 
   int copy;
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * rs2 ];
 
   dbg_printf("VMV.X.S r%d, v%d\n", vd, rs2 );
@@ -2481,7 +5214,7 @@ void ac_behavior(VMVXS) {
 // Instruction VSLLVV behavior method
 void ac_behavior(VSLLVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -2508,6 +5241,8 @@ void ac_behavior(VSLLVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2521,7 +5256,7 @@ void ac_behavior(VSLLVV) {
 // Instruction VSLLVX behavior method
 void ac_behavior(VSLLVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2548,6 +5283,8 @@ void ac_behavior(VSLLVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2561,7 +5298,7 @@ void ac_behavior(VSLLVX) {
 // Instruction VSLLVI behavior method
 void ac_behavior(VSLLVI) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2588,6 +5325,8 @@ void ac_behavior(VSLLVI) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2601,7 +5340,7 @@ void ac_behavior(VSLLVI) {
 // Instruction VSRLVV behavior method
 void ac_behavior(VSRLVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
@@ -2628,6 +5367,8 @@ void ac_behavior(VSRLVV) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2641,7 +5382,7 @@ void ac_behavior(VSRLVV) {
 // Instruction VSRLVX behavior method
 void ac_behavior(VSRLVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2668,6 +5409,8 @@ void ac_behavior(VSRLVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2681,7 +5424,7 @@ void ac_behavior(VSRLVX) {
 // Instruction VSRLVI behavior method
 void ac_behavior(VSRLVI) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -2708,6 +5451,8 @@ void ac_behavior(VSRLVI) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -2722,7 +5467,7 @@ void ac_behavior(VSRLVI) {
 void ac_behavior(VMVSX) {
 
   int copy = RB[rs1];
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
 
   dbg_printf("VMV.S.X v%d, r%d\n", vd, rs1 );
@@ -2741,268 +5486,113 @@ void ac_behavior(VMVSX) {
 
 }
 
-// Instruction VMSEQVV behavior method
-void ac_behavior(VMSEQVV) {
-
-  int sew = 1 << ( vtype >> 3 );
-  v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
-  v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
-  v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
-
-  int vlmax = 128 / ( 8 * sew );
-  
-  dbg_printf("VMSEQ.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
-
-  for (int el = 0; el < vl; el++) {
-
-    int idx = el % vlmax;
-
-    if ( sew == 1 ) {
-      v0->set8( idx, ( v2->get8( idx ) == ( uint8_t ) v1->get8( idx ) ) ? 1 : 0 );
-    } else if ( sew == 2 ) {
-      v0->set16( idx, ( v2->get16( idx ) == ( uint16_t ) v1->get16( idx ) ) ? 1 : 0 );
-    } else if ( sew == 4 ) {
-      v0->set32( idx, ( v2->get32( idx ) == ( uint32_t ) v1->get32( idx ) ) ? 1 : 0 );
-    }
+// Instruction VMVVV behavior method
+void ac_behavior(VMVVV) {
 
-    if ( idx == vlmax-1 ) {
-      v0++; v1++; v2++;
-    }
+  dbg_printf("VMV.V.V v%d, v%d\n", vd, rs1 );
 
-  }
+  vcopy_body( vd, rs1 );
 
-  v0 = ( v128 * ) &RBV[ 4 * vd ];
-  for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
-    int i = c % 4;
-    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v0->w[ i ]);
-    if ( i == 3 ) v0++;
-  }
-  dbg_printf("bytes = %d\n\n", vl * sew);
+  dbg_vreg( vd );
 
 }
 
-// Instruction VMSEQVX behavior method
-void ac_behavior(VMSEQVX) {
-
-  int sew = 1 << ( vtype >> 3 );
-  v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
-  v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
+// Instruction VMVVX behavior method
+void ac_behavior(VMVVX) {
 
-  int vlmax = 128 / ( 8 * sew );
-  
-  dbg_printf("VMSEQ.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("VMV.V.X v%d, r%d\n", vd, rs1 );
   dbg_printf("RB[rs1] = %d\n", RB[rs1]);
 
-  for (int el = 0; el < vl; el++) {
-
-    int idx = el % vlmax;
-
-    if ( sew == 1 ) {
-      v0->set8( idx, ( v1->get8( idx ) == ( uint8_t ) RB[rs1] ) ? 1 : 0 );
-    } else if ( sew == 2 ) {
-      v0->set16( idx, ( v1->get16( idx ) == ( uint16_t ) RB[rs1] ) ? 1 : 0 );
-    } else if ( sew == 4 ) {
-      v0->set32( idx, ( v1->get32( idx ) == ( uint32_t ) RB[rs1] ) ? 1 : 0 );
-    }
-
-    if ( idx == vlmax-1 ) {
-      v0++; v1++;
-    }
-
-  }
+  vsplat_body( vd, RB[rs1] );
 
-  v0 = ( v128 * ) &RBV[ 4 * vd ];
-  for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
-    int i = c % 4;
-    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v0->w[ i ]);
-    if ( i == 3 ) v0++;
-  }
-  dbg_printf("bytes = %d\n\n", vl * sew);
+  dbg_vreg( vd );
 
 }
 
-// Instruction VMSEQVI behavior method
-void ac_behavior(VMSEQVI) {
-
-  int sew = 1 << ( vtype >> 3 );
-  v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
-  v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
+// Instruction VMVVI behavior method
+void ac_behavior(VMVVI) {
 
-  int vlmax = 128 / ( 8 * sew );
   int imm = sign_extend( rs1, 5 );
-  
-  dbg_printf("VMSEQ.VI v%d, v%d, r%d\n", vd, rs2, rs1 );
-
-  for (int el = 0; el < vl; el++) {
 
-    int idx = el % vlmax;
-
-    if ( sew == 1 ) {
-      v0->set8( idx, ( v1->get8( idx ) == imm ) ? 1 : 0 );
-    } else if ( sew == 2 ) {
-      v0->set16( idx, ( v1->get16( idx ) == imm ) ? 1 : 0 );
-    } else if ( sew == 4 ) {
-      v0->set32( idx, ( v1->get32( idx ) == imm ) ? 1 : 0 );
-    }
-
-    if ( idx == vlmax-1 ) {
-      v0++; v1++;
-    }
+  dbg_printf("VMV.V.I v%d, %d\n", vd, imm );
 
-  }
+  vsplat_body( vd, imm );
 
-  v0 = ( v128 * ) &RBV[ 4 * vd ];
-  for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
-    int i = c % 4;
-    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v0->w[ i ]);
-    if ( i == 3 ) v0++;
-  }
-  dbg_printf("bytes = %d\n\n", vl * sew);
+  dbg_vreg( vd );
 
 }
 
-// Instruction VMSNEVV behavior method
-void ac_behavior(VMSNEVV) {
-
-  int sew = 1 << ( vtype >> 3 );
-  v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
-  v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
-  v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
-
-  int vlmax = 128 / ( 8 * sew );
-  
-  dbg_printf("VMSNE.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
-
-  for (int el = 0; el < vl; el++) {
-
-    int idx = el % vlmax;
-
-    if ( sew == 1 ) {
-      v0->set8( idx, ( v2->get8( idx ) != ( uint8_t ) v1->get8( idx ) ) ? 1 : 0 );
-    } else if ( sew == 2 ) {
-      v0->set16( idx, ( v2->get16( idx ) != ( uint16_t ) v1->get16( idx ) ) ? 1 : 0 );
-    } else if ( sew == 4 ) {
-      v0->set32( idx, ( v2->get32( idx ) != ( uint32_t ) v1->get32( idx ) ) ? 1 : 0 );
-    }
+// Instruction VMERGEVVM behavior method
+void ac_behavior(VMERGEVVM) {
 
-    if ( idx == vlmax-1 ) {
-      v0++; v1++; v2++;
-    }
+  dbg_printf("VMERGE.VVM v%d, v%d, v%d, v0\n", vd, rs2, rs1 );
 
-  }
+  vexec_vvm< vu8x16, vu16x8, vu32x4 >( vmerge_op(), vd, rs2, rs1, true );
 
-  v0 = ( v128 * ) &RBV[ 4 * vd ];
-  for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
-    int i = c % 4;
-    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v0->w[ i ]);
-    if ( i == 3 ) v0++;
-  }
-  dbg_printf("bytes = %d\n\n", vl * sew);
+  dbg_vreg( vd );
 
 }
 
-// Instruction VMSNEVX behavior method
-void ac_behavior(VMSNEVX) {
-
-  int sew = 1 << ( vtype >> 3 );
-  v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
-  v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
+// Instruction VMERGEVXM behavior method
+void ac_behavior(VMERGEVXM) {
 
-  int vlmax = 128 / ( 8 * sew );
-  
-  dbg_printf("VMSNE.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("VMERGE.VXM v%d, v%d, r%d, v0\n", vd, rs2, rs1 );
   dbg_printf("RB[rs1] = %d\n", RB[rs1]);
 
-  for (int el = 0; el < vl; el++) {
-
-    int idx = el % vlmax;
-
-    if ( sew == 1 ) {
-      v0->set8( idx, ( v1->get8( idx ) != ( uint8_t ) RB[rs1] ) ? 1 : 0 );
-    } else if ( sew == 2 ) {
-      v0->set16( idx, ( v1->get16( idx ) != ( uint16_t ) RB[rs1] ) ? 1 : 0 );
-    } else if ( sew == 4 ) {
-      v0->set32( idx, ( v1->get32( idx ) != ( uint32_t ) RB[rs1] ) ? 1 : 0 );
-    }
+  vexec_vxm< vu8x16, vu16x8, vu32x4 >( vmerge_op(), vd, rs2, RB[rs1], true );
 
-    if ( idx == vlmax-1 ) {
-      v0++; v1++;
-    }
+  dbg_vreg( vd );
 
-  }
+}
 
-  v0 = ( v128 * ) &RBV[ 4 * vd ];
-  for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
-    int i = c % 4;
-    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v0->w[ i ]);
-    if ( i == 3 ) v0++;
-  }
-  dbg_printf("bytes = %d\n\n", vl * sew);
+// Instruction VMERGEVIM behavior method
+void ac_behavior(VMERGEVIM) {
 
-}
+  int imm = sign_extend( rs1, 5 );
 
-// Instruction VMSNEVI behavior method
-void ac_behavior(VMSNEVI) {
+  dbg_printf("VMERGE.VIM v%d, v%d, %d, v0\n", vd, rs2, imm );
 
-  int sew = 1 << ( vtype >> 3 );
-  v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
-  v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
+  vexec_vxm< vu8x16, vu16x8, vu32x4 >( vmerge_op(), vd, rs2, imm, true );
 
-  int vlmax = 128 / ( 8 * sew );
-  int imm = sign_extend( rs1, 5 );
-  
-  dbg_printf("VMSNE.VI v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_vreg( vd );
 
-  for (int el = 0; el < vl; el++) {
+}
 
-    int idx = el % vlmax;
+// Instruction VMVRV behavior method
+void ac_behavior(VMVRV) {
 
-    if ( sew == 1 ) {
-      v0->set8( idx, ( v1->get8( idx ) != imm ) ? 1 : 0 );
-    } else if ( sew == 2 ) {
-      v0->set16( idx, ( v1->get16( idx ) != imm ) ? 1 : 0 );
-    } else if ( sew == 4 ) {
-      v0->set32( idx, ( v1->get32( idx ) != imm ) ? 1 : 0 );
-    }
+  int nr = rs1 + 1;
 
-    if ( idx == vlmax-1 ) {
-      v0++; v1++;
-    }
+  dbg_printf("VMV%dR.V v%d, v%d\n", nr, vd, rs2 );
 
-  }
+  memmove( &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], 16 * nr );
 
-  v0 = ( v128 * ) &RBV[ 4 * vd ];
-  for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
-    int i = c % 4;
-    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v0->w[ i ]);
-    if ( i == 3 ) v0++;
-  }
-  dbg_printf("bytes = %d\n\n", vl * sew);
+  dbg_printf("bytes = %d\n\n", 16 * nr);
 
 }
 
-// Instruction VMSLTVV behavior method
-void ac_behavior(VMSLTVV) {
+// Instruction VMSEQVV behavior method
+void ac_behavior(VMSEQVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
 
   int vlmax = 128 / ( 8 * sew );
   
-  dbg_printf("VMSLT.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+  dbg_printf("VMSEQ.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
 
   for (int el = 0; el < vl; el++) {
 
     int idx = el % vlmax;
 
     if ( sew == 1 ) {
-      v0->set8( idx, ( v2->get8( idx ) < v1->get8( idx ) ) ? 1 : 0 );
+      v0->set8( idx, ( v2->get8( idx ) == ( uint8_t ) v1->get8( idx ) ) ? 1 : 0 );
     } else if ( sew == 2 ) {
-      v0->set16( idx, ( v2->get16( idx ) < v1->get16( idx ) ) ? 1 : 0 );
+      v0->set16( idx, ( v2->get16( idx ) == ( uint16_t ) v1->get16( idx ) ) ? 1 : 0 );
     } else if ( sew == 4 ) {
-      v0->set32( idx, ( v2->get32( idx ) < v1->get32( idx ) ) ? 1 : 0 );
+      v0->set32( idx, ( v2->get32( idx ) == ( uint32_t ) v1->get32( idx ) ) ? 1 : 0 );
     }
 
     if ( idx == vlmax-1 ) {
@@ -3011,45 +5601,7 @@ void ac_behavior(VMSLTVV) {
 
   }
 
-  v0 = ( v128 * ) &RBV[ 4 * vd ];
-  for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
-    int i = c % 4;
-    dbg_printf("v%d[%d] = %d\n", vd + c/4, i, v0->w[ i ]);
-    if ( i == 3 ) v0++;
-  }
-  dbg_printf("bytes = %d\n\n", vl * sew);
-
-}
-
-// Instruction VMSLTVX behavior method
-void ac_behavior(VMSLTVX) {
-
-  int sew = 1 << ( vtype >> 3 );
-  v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
-  v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
-
-  int vlmax = 128 / ( 8 * sew );
-  
-  dbg_printf("VMSLT.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
-  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
-
-  for (int el = 0; el < vl; el++) {
-
-    int idx = el % vlmax;
-
-    if ( sew == 1 ) {
-      v0->set8( idx, ( v1->get8( idx ) < RB[rs1] ) ? 1 : 0 );
-    } else if ( sew == 2 ) {
-      v0->set16( idx, ( v1->get16( idx ) < RB[rs1] ) ? 1 : 0 );
-    } else if ( sew == 4 ) {
-      v0->set32( idx, ( v1->get32( idx ) < RB[rs1] ) ? 1 : 0 );
-    }
-
-    if ( idx == vlmax-1 ) {
-      v0++; v1++;
-    }
-
-  }
+  vtail_fill( vd, vl * sew );
 
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
@@ -3061,36 +5613,38 @@ void ac_behavior(VMSLTVX) {
 
 }
 
-// Instruction VMSLEVV behavior method
-void ac_behavior(VMSLEVV) {
+// Instruction VMSEQVX behavior method
+void ac_behavior(VMSEQVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
-  v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
-  v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
+  v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
   int vlmax = 128 / ( 8 * sew );
   
-  dbg_printf("VMSLE.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+  dbg_printf("VMSEQ.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
 
   for (int el = 0; el < vl; el++) {
 
     int idx = el % vlmax;
 
     if ( sew == 1 ) {
-      v0->set8( idx, ( v2->get8( idx ) <= v1->get8( idx ) ) ? 1 : 0 );
+      v0->set8( idx, ( v1->get8( idx ) == ( uint8_t ) RB[rs1] ) ? 1 : 0 );
     } else if ( sew == 2 ) {
-      v0->set16( idx, ( v2->get16( idx ) <= v1->get16( idx ) ) ? 1 : 0 );
+      v0->set16( idx, ( v1->get16( idx ) == ( uint16_t ) RB[rs1] ) ? 1 : 0 );
     } else if ( sew == 4 ) {
-      v0->set32( idx, ( v2->get32( idx ) <= v1->get32( idx ) ) ? 1 : 0 );
+      v0->set32( idx, ( v1->get32( idx ) == ( uint32_t ) RB[rs1] ) ? 1 : 0 );
     }
 
     if ( idx == vlmax-1 ) {
-      v0++; v1++; v2++;
+      v0++; v1++;
     }
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -3101,28 +5655,28 @@ void ac_behavior(VMSLEVV) {
 
 }
 
-// Instruction VMSLEVX behavior method
-void ac_behavior(VMSLEVX) {
+// Instruction VMSEQVI behavior method
+void ac_behavior(VMSEQVI) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
-  v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
+  v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
 
   int vlmax = 128 / ( 8 * sew );
+  int imm = sign_extend( rs1, 5 );
   
-  dbg_printf("VMSLE.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
-  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+  dbg_printf("VMSEQ.VI v%d, v%d, r%d\n", vd, rs2, rs1 );
 
   for (int el = 0; el < vl; el++) {
 
     int idx = el % vlmax;
 
     if ( sew == 1 ) {
-      v0->set8( idx, ( v1->get8( idx ) <= RB[rs1] ) ? 1 : 0 );
+      v0->set8( idx, ( v1->get8( idx ) == imm ) ? 1 : 0 );
     } else if ( sew == 2 ) {
-      v0->set16( idx, ( v1->get16( idx ) <= RB[rs1] ) ? 1 : 0 );
+      v0->set16( idx, ( v1->get16( idx ) == imm ) ? 1 : 0 );
     } else if ( sew == 4 ) {
-      v0->set32( idx, ( v1->get32( idx ) <= RB[rs1] ) ? 1 : 0 );
+      v0->set32( idx, ( v1->get32( idx ) == imm ) ? 1 : 0 );
     }
 
     if ( idx == vlmax-1 ) {
@@ -3131,6 +5685,8 @@ void ac_behavior(VMSLEVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -3141,36 +5697,38 @@ void ac_behavior(VMSLEVX) {
 
 }
 
-// Instruction VMSLEVI behavior method
-void ac_behavior(VMSLEVI) {
+// Instruction VMSNEVV behavior method
+void ac_behavior(VMSNEVV) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
+  v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
 
   int vlmax = 128 / ( 8 * sew );
-  int imm = sign_extend( rs1, 5 );
   
-  dbg_printf("VMSLE.VI v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("VMSNE.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
 
   for (int el = 0; el < vl; el++) {
 
     int idx = el % vlmax;
 
     if ( sew == 1 ) {
-      v0->set8( idx, ( v1->get8( idx ) <= imm ) ? 1 : 0 );
+      v0->set8( idx, ( v2->get8( idx ) != ( uint8_t ) v1->get8( idx ) ) ? 1 : 0 );
     } else if ( sew == 2 ) {
-      v0->set16( idx, ( v1->get16( idx ) <= imm ) ? 1 : 0 );
+      v0->set16( idx, ( v2->get16( idx ) != ( uint16_t ) v1->get16( idx ) ) ? 1 : 0 );
     } else if ( sew == 4 ) {
-      v0->set32( idx, ( v1->get32( idx ) <= imm ) ? 1 : 0 );
+      v0->set32( idx, ( v2->get32( idx ) != ( uint32_t ) v1->get32( idx ) ) ? 1 : 0 );
     }
 
     if ( idx == vlmax-1 ) {
-      v0++; v1++;
+      v0++; v1++; v2++;
     }
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -3181,16 +5739,16 @@ void ac_behavior(VMSLEVI) {
 
 }
 
-// Instruction VMSGTVX behavior method
-void ac_behavior(VMSGTVX) {
+// Instruction VMSNEVX behavior method
+void ac_behavior(VMSNEVX) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs2 ];
 
   int vlmax = 128 / ( 8 * sew );
   
-  dbg_printf("VMSGT.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("VMSNE.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
   dbg_printf("RB[rs1] = %d\n", RB[rs1]);
 
   for (int el = 0; el < vl; el++) {
@@ -3198,11 +5756,11 @@ void ac_behavior(VMSGTVX) {
     int idx = el % vlmax;
 
     if ( sew == 1 ) {
-      v0->set8( idx, ( v1->get8( idx ) > RB[rs1] ) ? 1 : 0 );
+      v0->set8( idx, ( v1->get8( idx ) != ( uint8_t ) RB[rs1] ) ? 1 : 0 );
     } else if ( sew == 2 ) {
-      v0->set16( idx, ( v1->get16( idx ) > RB[rs1] ) ? 1 : 0 );
+      v0->set16( idx, ( v1->get16( idx ) != ( uint16_t ) RB[rs1] ) ? 1 : 0 );
     } else if ( sew == 4 ) {
-      v0->set32( idx, ( v1->get32( idx ) > RB[rs1] ) ? 1 : 0 );
+      v0->set32( idx, ( v1->get32( idx ) != ( uint32_t ) RB[rs1] ) ? 1 : 0 );
     }
 
     if ( idx == vlmax-1 ) {
@@ -3211,6 +5769,8 @@ void ac_behavior(VMSGTVX) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -3221,28 +5781,28 @@ void ac_behavior(VMSGTVX) {
 
 }
 
-// Instruction VMSGTVI behavior method
-void ac_behavior(VMSGTVI) {
+// Instruction VMSNEVI behavior method
+void ac_behavior(VMSNEVI) {
 
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v0 = ( v128 * ) &RBV[ 4 * vd ];
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
 
   int vlmax = 128 / ( 8 * sew );
   int imm = sign_extend( rs1, 5 );
   
-  dbg_printf("VMSGT.VI v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("VMSNE.VI v%d, v%d, r%d\n", vd, rs2, rs1 );
 
   for (int el = 0; el < vl; el++) {
 
     int idx = el % vlmax;
 
     if ( sew == 1 ) {
-      v0->set8( idx, ( v1->get8( idx ) > imm ) ? 1 : 0 );
+      v0->set8( idx, ( v1->get8( idx ) != imm ) ? 1 : 0 );
     } else if ( sew == 2 ) {
-      v0->set16( idx, ( v1->get16( idx ) > imm ) ? 1 : 0 );
+      v0->set16( idx, ( v1->get16( idx ) != imm ) ? 1 : 0 );
     } else if ( sew == 4 ) {
-      v0->set32( idx, ( v1->get32( idx ) > imm ) ? 1 : 0 );
+      v0->set32( idx, ( v1->get32( idx ) != imm ) ? 1 : 0 );
     }
 
     if ( idx == vlmax-1 ) {
@@ -3251,6 +5811,8 @@ void ac_behavior(VMSGTVI) {
 
   }
 
+  vtail_fill( vd, vl * sew );
+
   v0 = ( v128 * ) &RBV[ 4 * vd ];
   for( int c = 0; c < ( vl * sew ) / 4; c++ ) {
     int i = c % 4;
@@ -3261,11 +5823,179 @@ void ac_behavior(VMSGTVI) {
 
 }
 
+// Instruction VMSLTVV behavior method
+void ac_behavior(VMSLTVV) {
+
+  dbg_printf("VMSLT.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vs8x16, vs16x8, vs32x4 >( vmslt_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSLTVX behavior method
+void ac_behavior(VMSLTVX) {
+
+  dbg_printf("VMSLT.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vs8x16, vs16x8, vs32x4 >( vmslt_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSLEVV behavior method
+void ac_behavior(VMSLEVV) {
+
+  dbg_printf("VMSLE.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vs8x16, vs16x8, vs32x4 >( vmsle_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSLEVX behavior method
+void ac_behavior(VMSLEVX) {
+
+  dbg_printf("VMSLE.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vs8x16, vs16x8, vs32x4 >( vmsle_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSLEVI behavior method
+void ac_behavior(VMSLEVI) {
+
+  int imm = sign_extend( rs1, 5 );
+
+  dbg_printf("VMSLE.VI v%d, v%d, %d\n", vd, rs2, imm );
+
+  vexec_vx< vs8x16, vs16x8, vs32x4 >( vmsle_op(), vd, rs2, imm );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSGTVX behavior method
+void ac_behavior(VMSGTVX) {
+
+  dbg_printf("VMSGT.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vs8x16, vs16x8, vs32x4 >( vmsgt_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSGTVI behavior method
+void ac_behavior(VMSGTVI) {
+
+  int imm = sign_extend( rs1, 5 );
+
+  dbg_printf("VMSGT.VI v%d, v%d, %d\n", vd, rs2, imm );
+
+  vexec_vx< vs8x16, vs16x8, vs32x4 >( vmsgt_op(), vd, rs2, imm );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSLTUVV behavior method
+void ac_behavior(VMSLTUVV) {
+
+  dbg_printf("VMSLTU.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vu8x16, vu16x8, vu32x4 >( vmslt_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSLTUVX behavior method
+void ac_behavior(VMSLTUVX) {
+
+  dbg_printf("VMSLTU.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vu8x16, vu16x8, vu32x4 >( vmslt_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSLEUVV behavior method
+void ac_behavior(VMSLEUVV) {
+
+  dbg_printf("VMSLEU.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  vexec_vv< vu8x16, vu16x8, vu32x4 >( vmsle_op(), vd, rs2, rs1 );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSLEUVX behavior method
+void ac_behavior(VMSLEUVX) {
+
+  dbg_printf("VMSLEU.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vu8x16, vu16x8, vu32x4 >( vmsle_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSLEUVI behavior method
+void ac_behavior(VMSLEUVI) {
+
+  int imm = sign_extend( rs1, 5 );
+
+  dbg_printf("VMSLEU.VI v%d, v%d, %d\n", vd, rs2, imm );
+
+  vexec_vx< vu8x16, vu16x8, vu32x4 >( vmsle_op(), vd, rs2, imm );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSGTUVX behavior method
+void ac_behavior(VMSGTUVX) {
+
+  dbg_printf("VMSGTU.VX v%d, v%d, r%d\n", vd, rs2, rs1 );
+  dbg_printf("RB[rs1] = %d\n", RB[rs1]);
+
+  vexec_vx< vu8x16, vu16x8, vu32x4 >( vmsgt_op(), vd, rs2, RB[rs1] );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VMSGTUVI behavior method
+void ac_behavior(VMSGTUVI) {
+
+  int imm = sign_extend( rs1, 5 );
+
+  dbg_printf("VMSGTU.VI v%d, v%d, %d\n", vd, rs2, imm );
+
+  vexec_vx< vu8x16, vu16x8, vu32x4 >( vmsgt_op(), vd, rs2, imm );
+
+  dbg_vreg( vd );
+
+}
+
 // Instruction VREDSUMVS behavior method
 void ac_behavior(VREDSUMVS) {
 
   int sum;
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -3319,7 +6049,7 @@ void ac_behavior(VREDSUMVS) {
 void ac_behavior(VWREDSUMUVS) {
 
   int sum;
-  int sew = 1 << ( vtype >> 3 );
+  int sew = vcfg.sew;
   v128 *v1 = ( v128 * ) &RBV[ 4 * rs1 ];
   v128 *v2 = ( v128 * ) &RBV[ 4 * rs2 ];
 
@@ -3361,3 +6091,178 @@ void ac_behavior(VWREDSUMUVS) {
   }
 
 }
+
+// Vector FP behaviors (F at SEW=32, Zvfh at SEW=16), in the dynamic
+// rounding mode of frm. See vf_binop.
+
+// Instruction VFADDVV behavior method
+void ac_behavior(VFADDVV) {
+
+  dbg_printf("VFADD.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_ADD, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], &RBV[ 4 * rs1 ], 0, vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFADDVF behavior method
+void ac_behavior(VFADDVF) {
+
+  dbg_printf("VFADD.VF v%d, v%d, f%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_ADD, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], NULL, vf_scalar( rs1 ), vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFSUBVV behavior method
+void ac_behavior(VFSUBVV) {
+
+  dbg_printf("VFSUB.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_SUB, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], &RBV[ 4 * rs1 ], 0, vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFSUBVF behavior method
+void ac_behavior(VFSUBVF) {
+
+  dbg_printf("VFSUB.VF v%d, v%d, f%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_SUB, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], NULL, vf_scalar( rs1 ), vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFMULVV behavior method
+void ac_behavior(VFMULVV) {
+
+  dbg_printf("VFMUL.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_MUL, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], &RBV[ 4 * rs1 ], 0, vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFMULVF behavior method
+void ac_behavior(VFMULVF) {
+
+  dbg_printf("VFMUL.VF v%d, v%d, f%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_MUL, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], NULL, vf_scalar( rs1 ), vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFDIVVV behavior method
+void ac_behavior(VFDIVVV) {
+
+  dbg_printf("VFDIV.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_DIV, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], &RBV[ 4 * rs1 ], 0, vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFDIVVF behavior method
+void ac_behavior(VFDIVVF) {
+
+  dbg_printf("VFDIV.VF v%d, v%d, f%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_DIV, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], NULL, vf_scalar( rs1 ), vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFMACCVV behavior method
+void ac_behavior(VFMACCVV) {
+
+  dbg_printf("VFMACC.VV v%d, v%d, v%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_MACC, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], &RBV[ 4 * rs1 ], 0, vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFMACCVF behavior method
+void ac_behavior(VFMACCVF) {
+
+  dbg_printf("VFMACC.VF v%d, v%d, f%d\n", vd, rs2, rs1 );
+
+  fp_round( 0x7 );
+  vf_binop( VF_MACC, &RBV[ 4 * vd ], &RBV[ 4 * rs2 ], NULL, vf_scalar( rs1 ), vl, vcfg.sew );
+  vtail_fill( vd, vl * vcfg.sew );
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFWCVTFFV behavior method
+// Halves to floats; the widened result fills a group twice the size of
+// vs2. Only SEW=16 sources exist (there is no double vector FP), so at
+// any other SEW the instruction leaves vd unchanged. So do the reserved
+// encodings: LMUL=8, whose widened group would be 16 registers, and a vd
+// not aligned to the widened group.
+void ac_behavior(VFWCVTFFV) {
+
+  dbg_printf("VFWCVT.F.F.V v%d, v%d\n", vd, rs2 );
+
+  int wide = vcfg.lmul8 < 8 ? 1 : vcfg.lmul8 / 4;
+  if ( vcfg.lmul8 == 64 || vd % wide ) {
+    dbg_printf("Reserved widening encoding, vd unchanged\n\n");
+    return;
+  }
+
+  if ( vcfg.sew == 2 ) {
+    host_h2f_block( ( float * ) &RBV[ 4 * vd ], ( uint16_t * ) &RBV[ 4 * rs2 ], vl );
+    vtail_fill( vd, vl * 4, 2 );
+  }
+
+  dbg_vreg( vd );
+
+}
+
+// Instruction VFNCVTFFW behavior method
+// Floats to halves, rounded with frm; SEW=16 destinations only, like
+// VFWCVTFFV
+void ac_behavior(VFNCVTFFW) {
+
+  dbg_printf("VFNCVT.F.F.W v%d, v%d\n", vd, rs2 );
+
+  if ( vcfg.sew == 2 ) {
+    fp_round( 0x7 );
+    host_f2h_block( ( uint16_t * ) &RBV[ 4 * vd ], ( float * ) &RBV[ 4 * rs2 ], vl );
+    vtail_fill( vd, vl * vcfg.sew );
+  }
+
+  dbg_vreg( vd );
+
+}
@@ -10,11 +10,23 @@
 *************************************************/
 
 #include "riscv_syscall.H"
+#include <mutex>
+#include <set>
 
 // 'using namespace' statement to allow access to all
 // riscv-specific datatypes
 using namespace riscv_parms;
 unsigned procNumber = 0;
+const char *riscv_program = NULL;  // ELF file of the first program loaded
+
+// Host descriptors the guest has open, saved by checkpoints. Guest and
+// host descriptors are the same numbers.
+std::set<int> riscv_guest_fds;
+std::mutex riscv_guest_fds_lock;
+
+// Drops the reservations on and saves the snapshot pages of guest memory
+// the syscall layer is about to write (riscv_isa.cpp)
+void riscv_store_check(ac_memport<ac_word, ac_Hword> &mem, ac_word addr, ac_word bytes);
 
 void riscv_syscall::get_buffer(int argn, unsigned char* buf, unsigned int size)
 {
@@ -29,6 +41,7 @@ void riscv_syscall::set_buffer(int argn, unsigned char* buf, unsigned int size)
 {
   unsigned int addr = RB[10+argn];
 
+  riscv_store_check(DM, addr, size);
   for (unsigned int i = 0; i<size; i++, addr++) {
     DM.write_byte(addr, buf[i]);
   }
@@ -38,6 +51,7 @@ void riscv_syscall::set_buffer_noinvert(int argn, unsigned char* buf, unsigned i
 {
   unsigned int addr = RB[10+argn];
 
+  riscv_store_check(DM, addr, size);
   for (unsigned int i = 0; i<size; i+=4, addr+=4) {
     DM.write(addr, *(unsigned int *) &buf[i]);
   }
@@ -53,6 +67,26 @@ void riscv_syscall::set_int(int argn, int val)
   RB[10+argn] = val;
 }
 
+void riscv_syscall::open()
+{
+  ac_syscall<ac_word, ac_Hword>::open();
+  int fd = get_int(0);
+  if (fd >= 0) {
+    std::lock_guard<std::mutex> hold(riscv_guest_fds_lock);
+    riscv_guest_fds.insert(fd);
+  }
+}
+
+void riscv_syscall::close()
+{
+  int fd = get_int(0);
+  ac_syscall<ac_word, ac_Hword>::close();
+  if (get_int(0) == 0) {
+    std::lock_guard<std::mutex> hold(riscv_guest_fds_lock);
+    riscv_guest_fds.erase(fd);
+  }
+}
+
 void riscv_syscall::return_from_syscall()
 {
   ac_pc = RB[1];
@@ -65,6 +99,9 @@ void riscv_syscall::set_prog_args(int argc, char **argv)
   unsigned int ac_argv[30];
   char ac_argstr[512];
 
+  if (!riscv_program && argc > 0)
+    riscv_program = strdup(argv[0]);
+
   base = AC_RAM_END - 512 - procNumber * 64 * 1024;
   for (i=0, j=0; i<argc; i++) {
     int len = strlen(argv[i]) + 1;
@@ -0,0 +1,86 @@
+/*
+*
+* @file        riscv_tlm.cpp
+* @version     1.0
+*
+*
+* @date        Oct 2026
+* @brief       TLM-2.0 data port for the ArchC RISC-V model
+*
+*
+*/
+
+#include "riscv_tlm.H"
+#include <stdlib.h>
+#include <string.h>
+
+riscv_tlm_port::riscv_tlm_port(sc_core::sc_module_name name, uint32_t size)
+    : sc_core::sc_module(name), socket("socket"), dmi_accesses(0),
+      transport_accesses(0), size(size), dmi_valid(false) {
+  socket.register_invalidate_direct_mem_ptr(this, &riscv_tlm_port::invalidate_direct_mem_ptr);
+  const char *quantum = getenv("RISCV_TLM_QUANTUM_NS");
+  unsigned long ns = quantum ? strtoul(quantum, NULL, 0) : 0;
+  tlm::tlm_global_quantum::instance().set(sc_core::sc_time(ns ? ns : 1000, sc_core::SC_NS));
+  keeper.reset();
+}
+
+// One access of bytes at address. The cached DMI region serves it when it
+// covers the whole access with the right permission; anything else is a
+// b_transport, after which the target may grant a new region.
+void riscv_tlm_port::access(tlm::tlm_command cmd, uint8_t *data, uint32_t address, unsigned bytes) {
+  bool is_read = cmd == tlm::TLM_READ_COMMAND;
+  if (dmi_valid && address >= dmi.get_start_address() &&
+      address + bytes - 1 <= dmi.get_end_address() &&
+      (is_read ? dmi.is_read_allowed() : dmi.is_write_allowed())) {
+    uint8_t *host = dmi.get_dmi_ptr() + (address - dmi.get_start_address());
+    if (is_read)
+      memcpy(data, host, bytes);
+    else
+      memcpy(host, data, bytes);
+    keeper.inc(is_read ? dmi.get_read_latency() : dmi.get_write_latency());
+    dmi_accesses++;
+  } else {
+    tlm::tlm_generic_payload trans;
+    sc_core::sc_time delay = keeper.get_local_time();
+    trans.set_command(cmd);
+    trans.set_address(address);
+    trans.set_data_ptr(data);
+    trans.set_data_length(bytes);
+    trans.set_streaming_width(bytes);
+    trans.set_byte_enable_ptr(NULL);
+    trans.set_dmi_allowed(false);
+    trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+    socket->b_transport(trans, delay);
+    if (trans.is_response_error())
+      SC_REPORT_ERROR(name(), trans.get_response_string().c_str());
+    keeper.set(delay);
+    transport_accesses++;
+    if (trans.is_dmi_allowed()) {
+      dmi.init();
+      dmi_valid = socket->get_direct_mem_ptr(trans, dmi);
+    }
+  }
+  if (keeper.need_sync())
+    keeper.sync();
+}
+
+void riscv_tlm_port::read(ac_ptr buf, uint32_t address, int wordsize) {
+  access(tlm::TLM_READ_COMMAND, buf.ptr8, address, wordsize / 8);
+}
+
+void riscv_tlm_port::read(ac_ptr buf, uint32_t address, int wordsize, int n_words) {
+  access(tlm::TLM_READ_COMMAND, buf.ptr8, address, wordsize / 8 * n_words);
+}
+
+void riscv_tlm_port::write(ac_ptr buf, uint32_t address, int wordsize) {
+  access(tlm::TLM_WRITE_COMMAND, buf.ptr8, address, wordsize / 8);
+}
+
+void riscv_tlm_port::write(ac_ptr buf, uint32_t address, int wordsize, int n_words) {
+  access(tlm::TLM_WRITE_COMMAND, buf.ptr8, address, wordsize / 8 * n_words);
+}
+
+void riscv_tlm_port::invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end) {
+  if (dmi_valid && start <= dmi.get_end_address() && end >= dmi.get_start_address())
+    dmi_valid = false;
+}
@@ -0,0 +1,34 @@
+#include <stddef.h>
+#include <stdio.h>
+#include "../../rv_hal/get_id.h"
+
+// Every hart adds ROUNDS to both counters, one at a time. Hart 0 waits
+// for the others and checks that no increment was lost.
+#define ROUNDS 10000
+
+void amo_count(int*counter, size_t n );
+void lrsc_count(int*counter, size_t n );
+
+static volatile int amo_counter, lrsc_counter, finished;
+
+int main() {
+
+    amo_count( ( int * )&amo_counter, ROUNDS );
+    lrsc_count( ( int * )&lrsc_counter, ROUNDS );
+    amo_count( ( int * )&finished, 1 );
+
+    if ( get_id() != 0 )
+        return 0;
+
+    while ( finished != HARTS )
+        ;
+
+    if ( amo_counter != HARTS * ROUNDS || lrsc_counter != HARTS * ROUNDS ) {
+        printf("atomics: amoadd %d, lr/sc %d, expected %d\n",
+               amo_counter, lrsc_counter, HARTS * ROUNDS);
+        return 1;
+    }
+
+    printf("atomics: ok\n");
+    return 0;
+}
@@ -0,0 +1,46 @@
+# void amo_count(int*counter, size_t n )
+# a0 = counter, a1 = n;
+# Adds 1 to *counter n times with amoadd.w
+#
+# void lrsc_count(int*counter, size_t n )
+# a0 = counter, a1 = n;
+# Adds 1 to *counter n times with an lr.w/sc.w loop
+#
+
+.text                               # Start text section
+.align 1                            # align to the 2 byte compressed instructions
+.global amo_count                   # define global function symbols
+.global lrsc_count
+
+amo_count:
+
+    li t0, 1                        # Increment
+
+amo_loop:
+
+    beqz a1, amo_done               # Finished?
+    amoadd.w zero, t0, (a0)         # *counter += 1
+    addi a1, a1, -1                 # Decrement number left
+    j amo_loop                      # Loop back
+
+amo_done:
+
+    ret                             # Finished
+
+lrsc_count:
+
+    beqz a1, lrsc_done              # Finished?
+
+lrsc_retry:
+
+    lr.w t0, (a0)                   # Reserve and get *counter
+    addi t0, t0, 1
+    sc.w t1, t0, (a0)               # Store it if nobody else did
+    bnez t1, lrsc_retry             # Lost the reservation, try again
+
+    addi a1, a1, -1                 # Decrement number left
+    j lrsc_count                    # Loop back
+
+lrsc_done:
+
+    ret                             # Finished
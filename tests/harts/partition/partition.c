@@ -0,0 +1,44 @@
+#include <stddef.h>
+#include <stdio.h>
+#include "../../rv_hal/get_id.h"
+
+// Each hart sums its own slice of the array, picked by mhartid, into its
+// own slot. Hart 0 waits for the others and checks the total, so the
+// run needs every hart to have its id, its stack and the shared memory.
+#define N 4096
+
+int hart_sum(const int*x, size_t n );
+
+static int data[ N ];
+static volatile int sums[ HARTS ];
+static volatile int ready[ HARTS ];
+
+int main() {
+
+    int id = get_id();
+    int first = id * N / HARTS, last = ( id + 1 ) * N / HARTS;
+
+    for ( int i = first; i < last; i++ )
+        data[ i ] = i;
+
+    sums[ id ] = hart_sum( data + first, last - first );
+    ready[ id ] = 1;
+
+    if ( id != 0 )
+        return 0;
+
+    int total = 0;
+    for ( int h = 0; h < HARTS; h++ ) {
+        while ( !ready[ h ] )
+            ;
+        total += sums[ h ];
+    }
+
+    if ( total != N * ( N - 1 ) / 2 ) {
+        printf("partition: sum %d, expected %d\n", total, N * ( N - 1 ) / 2);
+        return 1;
+    }
+
+    printf("partition: ok, %d harts\n", HARTS);
+    return 0;
+}
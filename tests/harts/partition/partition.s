@@ -0,0 +1,26 @@
+# int hart_sum(const int*x, size_t n )
+# a0 = x, a1 = n;
+# Returns the sum of x[0..n)
+#
+
+.text                               # Start text section
+.align 1                            # align to the 2 byte compressed instructions
+.global hart_sum                    # define global function symbol
+
+hart_sum:
+
+    li t0, 0                        # Clear the sum
+
+loop:
+
+    beqz a1, done                   # Finished?
+    lw t1, 0(a0)                    # Get x[i]
+    add t0, t0, t1                  # Add it to the sum
+    addi a0, a0, 4                  # Bump pointer
+    addi a1, a1, -1                 # Decrement number left
+    j loop                          # Loop back
+
+done:
+
+    mv a0, t0                       # Return the sum
+    ret                             # Finished
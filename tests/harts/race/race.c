@@ -0,0 +1,36 @@
+#include <stddef.h>
+#include <stdio.h>
+#include "../../rv_hal/get_id.h"
+
+// Every hart increments a shared counter without atomics and logs the
+// order of its turns. The final count and the log depend on how the
+// harts interleave, so they only repeat from run to run under
+// RISCV_DETERMINISTIC=1.
+#define ROUNDS 2000
+
+void race(int*counter, int*log, int*next, int id, size_t n );
+
+static volatile int counter, next, finished;
+static int turns[ HARTS * ROUNDS ];
+
+int main() {
+
+    int id = get_id();
+
+    race( ( int * )&counter, turns, ( int * )&next, id, ROUNDS );
+    __sync_fetch_and_add( &finished, 1 );
+
+    if ( id != 0 )
+        return 0;
+
+    while ( finished != HARTS )
+        ;
+
+    // FNV-1a over the turn order
+    unsigned hash = 2166136261u;
+    for ( int i = 0; i < HARTS * ROUNDS; i++ )
+        hash = ( hash ^ turns[ i ] ) * 16777619u;
+
+    printf("race: counter %d of %d, log %08x\n", counter, HARTS * ROUNDS, hash);
+    return 0;
+}
@@ -0,0 +1,33 @@
+# void race(int*counter, int*log, int*next, int id, size_t n )
+# a0 = counter, a1 = log, a2 = next, a3 = id, a4 = n;
+# n times: a plain, racy *counter += 1, then log[next++] = id, with
+# next taken by amoadd.w so the log records the order of the turns
+#
+
+.text                               # Start text section
+.align 1                            # align to the 2 byte compressed instructions
+.global race                        # define global function symbol
+
+race:
+
+    li t2, 1                        # Log slot increment
+
+loop:
+
+    beqz a4, done                   # Finished?
+
+    lw t0, 0(a0)                    # *counter += 1, not atomic
+    addi t0, t0, 1
+    sw t0, 0(a0)
+
+    amoadd.w t1, t2, (a2)           # Take the next log slot
+    slli t1, t1, 2
+    add t1, a1, t1
+    sw a3, 0(t1)                    # Record who got it
+
+    addi a4, a4, -1                 # Decrement number left
+    j loop                          # Loop back
+
+done:
+
+    ret                             # Finished
@@ -0,0 +1,32 @@
+#include <stddef.h>
+#include <stdio.h>
+
+int rvc(const int*x, int*y, size_t n );
+void rvc_copyd(const double*x, double*y, size_t n );
+
+int main() {
+
+    static const int inp[] = { 0x7, -0x9, 0x3, 0x12345 };
+    static const double inpd[] = { 1.5, -0.25, 3e100 };
+
+    int out[ sizeof inp / 4 ];
+    double outd[ sizeof inpd / 8 ];
+    int sum = 0;
+
+    int got = rvc( inp, out, sizeof inp / 4 );
+    for ( int i = 0; i < sizeof inp / 4; i++ ) {
+        if ( out[ i ] != ( ( 2 * inp[ i ] + 100 ) ^ 0x55 ) )
+            return 1;
+        sum += out[ i ];
+    }
+    if ( got != sum )
+        return 1;
+
+    rvc_copyd( inpd, outd, sizeof inpd / 8 );
+    for ( int i = 0; i < sizeof inpd / 8; i++ )
+        if ( outd[ i ] != inpd[ i ] )
+            return 1;
+
+    printf("rvc: ok\n");
+    return 0;
+}
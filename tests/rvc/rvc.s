@@ -0,0 +1,65 @@
+# int rvc(const int*x, int*y, size_t n )
+# a0 = x, a1 = y, a2 = n;
+# y[i] = (2 * x[i] + 100) ^ 0x55, returns the sum of y
+#
+# The 32-bit instructions between the compressed ones start on halfword
+# boundaries, so the fetch has to put them together from two words.
+
+.text                               # Start text section
+.align 1                            # align to the 2 byte compressed instructions
+.global rvc                         # define global function symbols
+.global rvc_copyd
+
+rvc:
+
+    c.addi sp, -16                  # Save ra and s0
+    c.swsp ra, 12(sp)
+    c.swsp s0, 8(sp)
+    c.li s0, 0                      # Clear the sum
+
+loop:
+
+    c.beqz a2, done                 # Finished?
+    c.lw a3, 0(a0)                  # Get x[i]
+    c.jal twice                     # Double it
+
+    addi a3, a3, 100                # 32-bit: too wide for c.addi
+    xori a3, a3, 0x55               # 32-bit: no compressed form
+
+    c.sw a3, 0(a1)                  # Store y[i]
+    c.add s0, a3                    # Add it to the sum
+
+    c.addi a0, 4                    # Bump pointers
+    c.addi a1, 4
+    c.addi a2, -1                   # Decrement number left
+    c.j loop                        # Loop back
+
+done:
+
+    c.mv a0, s0                     # Return the sum
+    c.lwsp s0, 8(sp)
+    c.lwsp ra, 12(sp)
+    c.addi sp, 16
+    c.jr ra                         # Finished
+
+twice:
+
+    c.slli a3, 1
+    c.jr ra
+
+# void rvc_copyd(const double*x, double*y, size_t n )
+# a0 = x, a1 = y, a2 = n;
+
+rvc_copyd:
+
+    c.beqz a2, copied               # Finished?
+    c.fld fa0, 0(a0)                # Get x[i]
+    c.fsd fa0, 0(a1)                # Store y[i]
+    c.addi a0, 8                    # Bump pointers
+    c.addi a1, 8
+    c.addi a2, -1                   # Decrement number left
+    c.j rvc_copyd                   # Loop back
+
+copied:
+
+    c.jr ra                         # Finished
@@ -0,0 +1,21 @@
+#include <stddef.h>
+#include <stdio.h>
+
+void vadc(const unsigned*xl, const unsigned*xh, const unsigned*yl, const unsigned*yh,
+          unsigned*zl, unsigned*zh, size_t n );
+
+int main() {
+
+    // 64-bit operands split into low and high limbs
+    static const unsigned xl[] = { 0xffffffff, 0x1, 0x80000000, 0xfffffffe };
+    static const unsigned xh[] = { 0x0, 0x2, 0x7fffffff, 0xffffffff };
+    static const unsigned yl[] = { 0x1, 0x1, 0x80000000, 0x1 };
+    static const unsigned yh[] = { 0x0, 0x3, 0x0, 0x0 };
+
+    unsigned zl[ sizeof xl / 4 ];
+    unsigned zh[ sizeof xl / 4 ];
+
+    vadc( xl, xh, yl, yh, zl, zh, sizeof xl / 4 );
+    
+    return 0;
+}
\ No newline at end of file
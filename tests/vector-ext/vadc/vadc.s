@@ -0,0 +1,38 @@
+# void vadc(const unsigned*xl, const unsigned*xh, const unsigned*yl, const unsigned*yh,
+#           unsigned*zl, unsigned*zh, size_t n )
+# a0 = xl, a1 = xh, a2 = yl, a3 = yh, a4 = zl, a5 = zh, a6 = n;
+#
+
+.text                               # Start text section
+.align 2                            # align 4 byte instructions by 2**2 bytes
+.global vadc                        # define global function symbol
+
+vadc:
+
+    vsetvli t0, a6, e32, ta,ma      # Set vector length based on 32-bit vectors
+    vle32.v v1, (a0)                # Get low limbs
+    vle32.v v2, (a2)
+
+    sub a6, a6, t0                  # Decrement number done
+    slli t0, t0, 2                  # Multiply number done by 4 bytes
+
+    vmadc.vv v0, v1, v2             # Carry out of the low limbs
+    vadd.vv v3, v1, v2              # Low limb sum
+
+    vle32.v v4, (a1)                # Get high limbs
+    vle32.v v5, (a3)
+    vadc.vvm v6, v4, v5, v0         # High limb sum with carry in
+
+    vse32.v v3, (a4)                # Store result
+    vse32.v v6, (a5)
+
+    add a0, a0, t0                  # Bump pointers
+    add a1, a1, t0
+    add a2, a2, t0
+    add a3, a3, t0
+    add a4, a4, t0
+    add a5, a5, t0
+
+    bnez a6, vadc                   # Loop back
+
+    ret                             # Finished
@@ -0,0 +1,16 @@
+#include <stddef.h>
+#include <stdio.h>
+
+void vdiv(const int*x, const int*y, int*z, size_t n );
+
+int main() {
+
+    static const int inp0[] = { 0x7, -0x9, 0x3, -0x80000000 };
+    static const int inp1[] = { 0x2, 0x2, 0x0, -0x1 };
+
+    int out[ sizeof inp0 ];
+
+    vdiv( inp0, inp1, out, sizeof inp0 / 4 );
+    
+    return 0;
+}
\ No newline at end of file
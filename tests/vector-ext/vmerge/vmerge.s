@@ -0,0 +1,37 @@
+# void vmerge(const int*x, const int*y, int*z, size_t n )
+# a0 = x, a1 = y, a2 = z, a3 = n;
+#
+# z[i] = x[i] < y[i] ? y[i] : 0
+
+.text                               # Start text section
+.align 2                            # align 4 byte instructions by 2**2 bytes
+.global vmerge                      # define global function symbol
+
+vmerge:
+
+    vsetvli t0, a3, e32, ta,ma      # Set vector length based on 32-bit vectors
+    vle32.v v1, (a0)                # Get first vector
+
+    sub a3, a3, t0                  # Decrement number done
+
+    slli t0, t0, 2                  # Multiply number done by 4 bytes
+    add a0, a0, t0                  # Bump pointer
+
+    vle32.v v2, (a1)                # Get second vector
+    add a1, a1, t0                  # Bump pointer
+
+    vmslt.vv v0, v1, v2             # Select lanes where x < y
+    vmv.v.i v3, 0                   # Splat zero
+    vmerge.vvm v4, v3, v2, v0       # Take y where selected
+
+    addi sp, sp, -16                # Spill and fill the result
+    vs1r.v v4, (sp)
+    vl1re32.v v5, (sp)
+    addi sp, sp, 16
+
+    vse32.v v5, (a2)                # Store result
+    add a2, a2, t0                  # Bump pointer
+
+    bnez a3, vmerge                 # Loop back
+
+    ret                             # Finished
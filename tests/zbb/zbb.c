@@ -0,0 +1,61 @@
+#include <stddef.h>
+#include <stdio.h>
+
+#define ZBB_OPS 13
+
+void zbb(const unsigned*x, unsigned*y, size_t n );
+
+// The same operations in plain C
+static void expect(unsigned x, unsigned*y ) {
+
+    unsigned bytes = 0;
+    int bits = 0, lead = 32, trail = 32;
+
+    for ( int b = 0; b < 32; b++ )
+        if ( x >> b & 1 ) {
+            bits++;
+            lead = 31 - b;
+            if ( trail == 32 )
+                trail = b;
+        }
+    for ( int b = 0; b < 32; b += 8 )
+        if ( x >> b & 0xff )
+            bytes |= 0xffu << b;
+
+    y[ 0 ] = lead;
+    y[ 1 ] = trail;
+    y[ 2 ] = bits;
+    y[ 3 ] = x << 24 | ( x & 0xff00 ) << 8 | ( x >> 8 & 0xff00 ) | x >> 24;
+    y[ 4 ] = bytes;
+    y[ 5 ] = ( signed char )x;
+    y[ 6 ] = x & 0xffff;
+    y[ 7 ] = x >> 8 | x << 24;
+    y[ 8 ] = x & ~0xffu;
+    y[ 9 ] = ( int )x > 0xff ? x : 0xff;
+    y[ 10 ] = ( 0xff << 2 ) + x;
+    y[ 11 ] = x | 0x80000000u;
+    y[ 12 ] = x >> 4 & 1;
+}
+
+int main() {
+
+    static const unsigned inp[] = { 0x0, 0x1, 0x80000000, 0x12345678, 0xff00ff7f, 0x10 };
+
+    unsigned out[ sizeof inp / 4 * ZBB_OPS ];
+    unsigned ref[ ZBB_OPS ];
+
+    zbb( inp, out, sizeof inp / 4 );
+
+    for ( int i = 0; i < sizeof inp / 4; i++ ) {
+        expect( inp[ i ], ref );
+        for ( int j = 0; j < ZBB_OPS; j++ )
+            if ( out[ i * ZBB_OPS + j ] != ref[ j ] ) {
+                printf("zbb: x = %#x, result %d = %#x, expected %#x\n",
+                       inp[ i ], j, out[ i * ZBB_OPS + j ], ref[ j ]);
+                return 1;
+            }
+    }
+
+    printf("zbb: ok\n");
+    return 0;
+}
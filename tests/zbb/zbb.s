@@ -0,0 +1,57 @@
+# void zbb(const unsigned*x, unsigned*y, size_t n )
+# a0 = x, a1 = y, a2 = n;
+# Stores the ZBB_OPS (13) results for each x[i], in the order of zbb.c
+#
+
+.text                               # Start text section
+.align 1                            # align to the 2 byte compressed instructions
+.global zbb                         # define global function symbol
+
+zbb:
+
+    li t2, 0xff                     # Second operand
+
+loop:
+
+    beqz a2, done                   # Finished?
+    lw t0, 0(a0)                    # Get x[i]
+
+    clz t1, t0                      # Zbb counts
+    sw t1, 0(a1)
+    ctz t1, t0
+    sw t1, 4(a1)
+    cpop t1, t0
+    sw t1, 8(a1)
+
+    rev8 t1, t0                     # Zbb byte operations
+    sw t1, 12(a1)
+    orc.b t1, t0
+    sw t1, 16(a1)
+    sext.b t1, t0
+    sw t1, 20(a1)
+    zext.h t1, t0
+    sw t1, 24(a1)
+
+    rori t1, t0, 8                  # Zbb rotate and logic
+    sw t1, 28(a1)
+    andn t1, t0, t2
+    sw t1, 32(a1)
+    max t1, t0, t2
+    sw t1, 36(a1)
+
+    sh2add t1, t2, t0               # Zba
+    sw t1, 40(a1)
+
+    bseti t1, t0, 31                # Zbs
+    sw t1, 44(a1)
+    bexti t1, t0, 4
+    sw t1, 48(a1)
+
+    addi a0, a0, 4                  # Bump pointers
+    addi a1, a1, 52
+    addi a2, a2, -1                 # Decrement number left
+    j loop                          # Loop back
+
+done:
+
+    ret                             # Finished
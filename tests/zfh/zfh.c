@@ -0,0 +1,33 @@
+#include <stddef.h>
+#include <stdio.h>
+
+// Halves are passed as their bit patterns
+void zfh_fma(const unsigned short*a, const unsigned short*b, const unsigned short*c, unsigned short*y, size_t n );
+void zfh_vec(const unsigned short*a, const unsigned short*b, const unsigned short*c, unsigned short*y, float*w, size_t n );
+
+int main() {
+
+    // 1.5 * 2 + 0.5, -2 * 0.5 + 1, (1 + 2^-10)^2 - 1, 1000 * -0.125 + 8.
+    // The third one is a tie in half precision and rounds to even.
+    static const unsigned short a[] = { 0x3e00, 0xc000, 0x3c01, 0x63d0 };
+    static const unsigned short b[] = { 0x4000, 0x3800, 0x3c01, 0xb000 };
+    static const unsigned short c[] = { 0x3800, 0x3c00, 0xbc00, 0x4800 };
+    static const unsigned short expect[] = { 0x4300, 0x0000, 0x1800, 0xd750 };
+    static const float expectw[] = { 3.5f, 0.0f, 0x1p-9f, -117.0f };
+
+    unsigned short y[ 4 ], yv[ 4 ];
+    float w[ 4 ];
+
+    zfh_fma( a, b, c, y, 4 );
+    zfh_vec( a, b, c, yv, w, 4 );
+
+    for ( int i = 0; i < 4; i++ )
+        if ( y[ i ] != expect[ i ] || yv[ i ] != expect[ i ] || w[ i ] != expectw[ i ] ) {
+            printf("zfh: element %d = %#x, %#x, %f, expected %#x, %f\n",
+                   i, y[ i ], yv[ i ], w[ i ], expect[ i ], expectw[ i ]);
+            return 1;
+        }
+
+    printf("zfh: ok\n");
+    return 0;
+}
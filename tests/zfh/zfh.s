@@ -0,0 +1,70 @@
+# void zfh_fma(const unsigned short*a, const unsigned short*b, const unsigned short*c, unsigned short*y, size_t n )
+# a0 = a, a1 = b, a2 = c, a3 = y, a4 = n;
+# y[i] = a[i] * b[i] + c[i] with scalar Zfh
+#
+# void zfh_vec(const unsigned short*a, const unsigned short*b, const unsigned short*c, unsigned short*y, float*w, size_t n )
+# a0 = a, a1 = b, a2 = c, a3 = y, a4 = w, a5 = n;
+# The same with vfmacc at SEW=16, then w[i] = y[i] widened with
+# vfwcvt. At most 4 elements per strip, so w fits one register.
+#
+
+.text                               # Start text section
+.align 1                            # align to the 2 byte compressed instructions
+.global zfh_fma                     # define global function symbols
+.global zfh_vec
+
+zfh_fma:
+
+    beqz a4, fma_done               # Finished?
+
+    flh ft0, 0(a0)                  # Get the operands
+    flh ft1, 0(a1)
+    flh ft2, 0(a2)
+
+    fmadd.h ft3, ft0, ft1, ft2      # One rounding to half
+    fsh ft3, 0(a3)                  # Store y[i]
+
+    addi a0, a0, 2                  # Bump pointers
+    addi a1, a1, 2
+    addi a2, a2, 2
+    addi a3, a3, 2
+    addi a4, a4, -1                 # Decrement number left
+    j zfh_fma                       # Loop back
+
+fma_done:
+
+    ret                             # Finished
+
+zfh_vec:
+
+    li t1, 4                        # Strip length
+    mv t0, a5
+    bleu t0, t1, strip
+    mv t0, t1
+
+strip:
+
+    vsetvli t0, t0, e16, ta,ma      # Set vector length for 16-bit elements
+    vle16.v v0, (a0)                # Get the operands
+    vle16.v v1, (a1)
+    vle16.v v2, (a2)
+
+    vfmacc.vv v2, v0, v1            # v2 = v0 * v1 + v2
+    vse16.v v2, (a3)                # Store y
+
+    vfwcvt.f.f.v v4, v2             # Widen to floats
+    vse32.v v4, (a4)                # Store w
+
+    sub a5, a5, t0                  # Decrement number done
+
+    slli t1, t0, 1                  # Bump half pointers
+    add a0, a0, t1
+    add a1, a1, t1
+    add a2, a2, t1
+    add a3, a3, t1
+    slli t1, t0, 2                  # Bump float pointer
+    add a4, a4, t1
+
+    bnez a5, zfh_vec                # Loop back
+
+    ret                             # Finished